@@ -69,6 +69,20 @@ def load_xcslib_statistics(statistics_filepath):
         5:'System Error',\
         6:'Problem Type'}
 
+    # columns added before the problem type by "save population statistics = on"
+    population_statistics = ['Average Prediction',\
+        'Average Fitness',\
+        'Average Error',\
+        'Average Action Set Size',\
+        'Average Experience',\
+        'Average Numerosity',\
+        'Average Time Stamp',\
+        'Population System Error',\
+        'Macroclassifiers',\
+        'GA Activations',\
+        'Covering Activations',\
+        'Subsumptions']
+
     if (statistics_filepath[-3:]==".gz"):
         df = pd.read_csv(statistics_filepath, header=None, sep="\t", compression="gzip")
     else:
@@ -78,8 +92,15 @@ def load_xcslib_statistics(statistics_filepath):
         df.rename(columns=column_names_ms,inplace = True)
     elif (len(df.columns)==7):
         df.rename(columns=column_names_ss,inplace = True)
+    elif (len(df.columns) in (6+len(population_statistics), 7+len(population_statistics))):
+        column_names = column_names_ms if (len(df.columns)==6+len(population_statistics)) else column_names_ss
+        last = len(column_names)-1
+        column_names = {c:column_names[c] for c in range(last)}
+        column_names.update({last+i:name for i,name in enumerate(population_statistics)})
+        column_names[len(df.columns)-1] = 'Problem Type'
+        df.rename(columns=column_names,inplace = True)
     else:
-        raise Exception("ERROR: wrong number of columns ("+str(len(df.columns))+") it should be 6 or 7")
+        raise Exception("ERROR: wrong number of columns ("+str(len(df.columns))+") it should be 6 or 7, or 19 or 20 with the population statistics")
     return df
 
 def match(condition,state,dontcare_symbol='#'):
@@ -0,0 +1,99 @@
+#!/bin/sh
+#
+#	runs the canonical scenarios with a fixed seed and collects the throughput section of the
+#	time reports, i.e., steps/s, problems/s, peak RSS, and the fingerprint of the final population
+#
+#	usage: run_scenarios.sh [-s <seed>] [-p <learning problems>] [-o <directory>] [<scenario> ...]
+#
+#	the executables are built with "make bench"; each scenario is run for one experiment in
+#	<directory>/<scenario> (default scenarios/) on a copy of the shipped configuration, with the
+#	seed and, if given, the number of learning problems replaced. The summary is written to
+#	<directory>/scenarios.txt, thus the fingerprints of two builds can be compared with diff.
+#
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+XCSLIB_DIR=$(cd "$BENCH_DIR/../.." && pwd)
+QLEARNING_DIR=$(cd "$XCSLIB_DIR/../qlearning" 2>/dev/null && pwd)
+
+SEED=1
+PROBLEMS=""
+OUTPUT=scenarios
+
+while getopts "s:p:o:" OPTION
+do
+	case $OPTION in
+		s) SEED=$OPTARG ;;
+		p) PROBLEMS=$OPTARG ;;
+		o) OUTPUT=$OPTARG ;;
+		*) echo "usage: $0 [-s <seed>] [-p <learning problems>] [-o <directory>] [<scenario> ...]"; exit 1 ;;
+	esac
+done
+shift $((OPTIND-1))
+
+SCENARIOS="$*"
+if [ -z "$SCENARIOS" ]
+then
+	SCENARIOS="mp6 mp11 mp20 mp37 eq53 maj5 woods1 woods2 maze4 maze5 maze6 woods14"
+fi
+
+#	scenario -> executable, directory of the configuration, and suffix
+scenario()
+{
+	case $1 in
+		mp6|mp11|mp20|mp37|eq53|maj5)
+			echo "xcs-bf $XCSLIB_DIR/examples/boolean_functions $1" ;;
+		woods1|woods2)
+			echo "xcs-woods $XCSLIB_DIR/examples/$1 $1" ;;
+		maze4|maze5|maze6|woods14)
+			echo "xcs-woods $QLEARNING_DIR/$1 ${1}q" ;;
+		*)
+			echo "" ;;
+	esac
+}
+
+mkdir -p "$OUTPUT"
+OUTPUT=$(cd "$OUTPUT" && pwd)
+SUMMARY="$OUTPUT/scenarios.txt"
+
+printf "Scenario\tSteps\tProblems\tStepsPerSecond\tProblemsPerSecond\tPeakRSS(KB)\tFingerprint\n" > "$SUMMARY"
+
+for NAME in $SCENARIOS
+do
+	set -- $(scenario "$NAME")
+	if [ $# -ne 3 ]
+	then
+		echo "unknown scenario $NAME"
+		exit 1
+	fi
+	EXECUTABLE="$XCSLIB_DIR/executables/$1"
+	SOURCE=$2
+	SUFFIX=$3
+
+	if [ ! -x "$EXECUTABLE" ]
+	then
+		echo "$EXECUTABLE not found, run make bench"
+		exit 1
+	fi
+
+	rm -rf "$OUTPUT/$NAME"
+	mkdir -p "$OUTPUT/$NAME"
+	cp "$SOURCE/confsys.$SUFFIX" "$OUTPUT/$NAME/"
+	cp "$SOURCE"/*.map "$OUTPUT/$NAME/" 2>/dev/null
+
+	sed -i -e "s/^\([[:space:]]*seed[[:space:]]*=\).*/\1 $SEED/" \
+		-e "s/^\([[:space:]]*first experiment[[:space:]]*=\).*/\1 0/" \
+		-e "s/^\([[:space:]]*number of experiments[[:space:]]*=\).*/\1 1/" \
+		"$OUTPUT/$NAME/confsys.$SUFFIX"
+	if [ -n "$PROBLEMS" ]
+	then
+		sed -i -e "s/^\([[:space:]]*number of learning problems[[:space:]]*=\).*/\1 $PROBLEMS/" "$OUTPUT/$NAME/confsys.$SUFFIX"
+	fi
+
+	echo "RUNNING $NAME"
+	(cd "$OUTPUT/$NAME" && "$EXECUTABLE" -f "$SUFFIX" > output.txt 2>&1)
+
+	LINE=$(grep -A1 "^THROUGHPUT" "$OUTPUT/$NAME/report.$SUFFIX-0001" | tail -1 | cut -f3-)
+	printf "%s\t%s\n" "$NAME" "$LINE" >> "$SUMMARY"
+done
+
+cat "$SUMMARY"
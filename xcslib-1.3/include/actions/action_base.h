@@ -56,6 +56,9 @@ public:
 	//! mutate the action 
 	virtual void mutate(const double& mu) = 0;
 
+	//! bytes allocated on the heap by the action, besides the object itself
+	virtual unsigned long allocated_size() const {return 0;};
+
 	//! set the action to the first available one (i.e., A0)
 	virtual void reset_action() {set_value(0);}; 
 
@@ -59,6 +59,9 @@ public:
 	string string_value() const;
 	void set_string_value(string);
 
+	//! bytes allocated on the heap by the action string
+	unsigned long allocated_size() const {return xcs_utility::heap_size(bitstring);};
+
 	void random();
 	void mutate(const double&); 
 };
@@ -106,6 +106,9 @@ public:
 	//! generate a random condition
 	virtual void random() = 0;
 
+	//! bytes allocated on the heap by the condition, besides the object itself
+	virtual unsigned long allocated_size() const {return 0;};
+
 	//! virtual destructor
 	virtual ~condition_base() {};
 	
@@ -12,6 +12,7 @@
 #include <string>
 #include "rl_definitions.h"
 #include "xcs_configuration_manager.h"
+#include "xcs_utility.h"
 #include "condition_base.h"
 #include "binary_inputs.h"
 
@@ -47,6 +48,9 @@ public:
 	//! return the condition size
 	unsigned long size() const {return bitstring.size();};
 
+	//! bytes allocated on the heap by the condition string
+	unsigned long allocated_size() const {return xcs_utility::heap_size(bitstring);};
+
 	//! Constructor for the ternary condition class that read the class parameters through the configuration manager
 	/*!
 	 *  This is the first constructor that must be used. Otherwise an error is returned.
@@ -80,6 +84,9 @@ public:
 	//! return true if the condition matches the input configuration
 	bool match(const binary_inputs& input) const;
 
+	//! return true if the condition matches the input string; it avoids copying the inputs when the same input is matched against many conditions
+	bool match(const string& input) const;
+
 	//! set the condition to cover the input 
 	void cover(const binary_inputs& input);
 
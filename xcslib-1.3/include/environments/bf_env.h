@@ -2,6 +2,7 @@
 #define __EQENV__
 
 #include <cassert>
+#include <cstdint>
 #include "rl_definitions.h"
 #include "environment_base.h"
 #include "xcs_configuration_manager.h"
@@ -20,7 +21,8 @@ class bf_env : public virtual environment_base
 		HIDDEN_PARITY_FUNCTION,
 		COUNT_ONES_FUNCTION, 
 		MAJORITY_ON_FUNCTION,
-		CARRY_FUNCTION
+		CARRY_FUNCTION,
+		HIERARCHICAL_MULTIPLEXER_FUNCTION
 	} t_binary_function;
 
 	string class_name() const { return string("bf_env"); };
@@ -58,6 +60,18 @@ class bf_env : public virtual environment_base
 
 	void save_state(ostream& output) const;
 	void restore_state(istream& input);
+
+	//! largest number of inputs whose configurations can be enumerated, e.g., to test the environment or to save the action-value function
+	static const unsigned long max_test_size = 24;
+
+	//! all the input configurations can be enumerated, up to max_test_size inputs \sa reset_problem
+	bool allow_test() const {return true;};
+
+	//! enumerate all the input configurations as test problems; the program stops if the inputs are more than max_test_size \sa reset_input
+	void reset_problem();
+
+	//! move to the next input configuration \sa next_input
+	bool next_problem() { return next_input(); };
 	
 	virtual double reward() const {assert(current_reward==bf_env::current_reward); return current_reward;};
 
@@ -75,6 +89,18 @@ class bf_env : public virtual environment_base
 	 */
 	t_state			inputs;			// input configuration
 
+	/*! 
+	 * \var vector<uint64_t> packed_inputs
+	 * \brief current input configuration packed in 64 bit words; 
+	 *
+	 * the last character of the input string is bit 0 of word 0, so that 
+	 * for inputs up to 64 bits the first word is the binary value of the string
+	 */
+	vector<uint64_t>	packed_inputs;
+
+	//! number of 64 bit words in packed_inputs
+	unsigned long		no_words;
+
 	/*! 
 	 * \var bool first_problem 
 	 * \brief true if the first problem is running
@@ -89,6 +115,9 @@ class bf_env : public virtual environment_base
 	//! selected variables
 	vector<unsigned long>		selected_inputs;
 
+	//! selected variables packed as a mask over packed_inputs
+	vector<uint64_t>		relevant_mask;
+
 	//! true if it the system must visit all the available configuration as a sequence
 	bool				uniform_start;		
 
@@ -110,15 +139,60 @@ class bf_env : public virtual environment_base
 	void set_parameters_mp(xcs_configuration_manager&);
 	void set_parameters_majority_on(xcs_configuration_manager&);
 	void set_parameters_count_ones(xcs_configuration_manager&);
+	void set_parameters_hidden_parity(xcs_configuration_manager&);
+	void set_parameters_carry(xcs_configuration_manager&);
+	void set_parameters_hierarchical_mp(xcs_configuration_manager&);
+
+	//! read the relevant inputs used by the hidden parity and the count ones functions
+	void set_relevant_inputs(xcs_configuration_manager&);
 
 	//! read selected variables
-	void read_selected_variables(char*, vector<unsigned long>&) const;
+	void read_selected_variables(const string&, vector<unsigned long>&) const;
+
+	//! return the value of the input in position pos of the input string
+	inline unsigned long input_bit(unsigned long pos) const
+	{
+		unsigned long bit = state_size-1-pos;
+		return (packed_inputs[bit>>6]>>(bit&63)) & 1UL;
+	};
+
+	//! return the value of the inputs in positions [pos,pos+len) read as a binary number (len<=64)
+	unsigned long long input_field(unsigned long pos, unsigned long len) const;
+
+	//! return the number of inputs set to one
+	inline unsigned long count_ones() const
+	{
+		unsigned long ones = 0;
+		for(unsigned long word=0; word<no_words; word++)
+			ones += __builtin_popcountll(packed_inputs[word]);
+		return ones;
+	};
+
+	//! return the number of selected inputs set to one \sa relevant_mask
+	inline unsigned long count_relevant_ones() const
+	{
+		unsigned long ones = 0;
+		for(unsigned long word=0; word<no_words; word++)
+			ones += __builtin_popcountll(packed_inputs[word] & relevant_mask[word]);
+		return ones;
+	};
+
+	//! set the packed inputs to the binary value of configuration
+	void set_packed_inputs(unsigned long configuration);
+
+	//! copy the packed inputs into the input string returned by state()
+	void update_inputs();
 
 	void perform_eq(const t_action& action);	
 	void perform_mp(const t_action& action);
 	void perform_majority_on(const t_action& action);
 	void perform_count_ones(const t_action& action);
 	void perform_carry(const t_action& action);
+	void perform_hidden_parity(const t_action& action);
+	void perform_hierarchical_mp(const t_action& action);
+
+	//! set the reward given the correct output of the function
+	void set_reward(unsigned long result, const t_action& action);
 
 	t_binary_function get_binary_function(string);
 	string print_binary_function(t_binary_function);
@@ -135,5 +209,16 @@ class bf_env : public virtual environment_base
 	// majority on parameters
 	unsigned long threshold;
 
+	// hidden parity and count ones parameters
+	unsigned long no_relevant_bits;
+
+	// carry parameters, size of each addend
+	unsigned long addend_size;
+
+	// hierarchical multiplexer parameters
+	unsigned long no_blocks;		//!< number of 3 bit blocks, i.e., the size of the top multiplexer
+	uint64_t block_mask;			//!< lowest bit of every block
+	bool flag_parity_blocks;		//!< true if the blocks are parity functions, false if they are 3 bit multiplexers
+
 };
 #endif
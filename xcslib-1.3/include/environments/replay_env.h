@@ -0,0 +1,91 @@
+#ifndef __REPLAY_ENV__
+#define __REPLAY_ENV__
+
+#include <vector>
+
+#include "rl_definitions.h"
+#include "environment_base.h"
+#include "xcs_configuration_manager.h"
+#include "xcs_interaction_stream.h"
+
+/*!
+ * \class replay_env replay_env.h
+ * \brief feeds back the interaction stream recorded by the experiment manager
+ *
+ * The environment reads the log saved with "record interaction stream = on" and, problem by
+ * problem, returns the recorded states, rewards, and ends of the problems, whatever action the
+ * classifier system performs; thus the classifier system can be profiled without the cost of the
+ * environment. The random numbers drawn by the recorded environment are skipped, so that, with
+ * the seed and the configuration of the recorded run, the classifier system performs exactly the
+ * same run. The actions that differ from the recorded ones are counted and reported at the end
+ * of each experiment, since from the first one on the run differs from the recorded one.
+ *
+ * The log is loaded once and shared by the copies of the environment.
+ * \sa xcs_interaction_stream
+ */
+class replay_env : public virtual environment_base
+{
+public:
+	string class_name() const { return string("replay_env"); };
+	string tag_name() const { return string("environment::replay"); };
+
+	//! Constructor for the replay environment class. It loads the log through the configuration manager.
+	replay_env(xcs_configuration_manager&);
+
+	void begin_experiment();
+	void end_experiment();
+
+	void begin_problem(const bool explore);
+	void end_problem() {};
+
+	bool stop() const { return current_stop; };
+	void perform(const t_action& action);
+	double reward() const { return current_reward; };
+	t_state state() const;
+
+	void trace(ostream& output) const;
+
+	//! the recorded problems can only be replayed in their order
+	bool allow_test() const {return false;};
+
+	void reset_input() {};
+	bool next_input() { return false; };
+
+	void save_state(ostream& output) const;
+	void restore_state(istream& input);
+
+	//! single step if the recorded environment was single step
+	bool single_step() const { return stream.single_step; };
+
+	//! number of actions that differed from the recorded ones in the current experiment
+	unsigned long divergent_actions() const { return no_divergent_actions; };
+
+private:
+	//! true if the log has been loaded
+	static bool						init;
+
+	//! log being replayed
+	static xcs_interaction_stream	stream;
+
+	//! states of the log converted once
+	static vector<t_state>			states;
+
+	//! name of the log
+	static string					stream_filename;
+
+	const static std::vector<std::string> configuration_parameters;
+
+	long			current_experiment;		//!< index of the current experiment in the log
+	unsigned long	current_problem;		//!< index of the current problem in the log
+	long			next_problem_index;		//!< index of the next problem within the current experiment
+	unsigned long	current_step;			//!< steps performed in the current problem
+
+	double			current_reward;			//!< reward of the last step performed
+	bool			current_stop;			//!< true if the last step performed ended the problem
+
+	unsigned long	no_steps;				//!< steps performed in the current experiment
+	unsigned long	no_divergent_actions;	//!< actions that differed from the recorded ones in the current experiment
+	unsigned long	no_divergent_modes;		//!< problems solved in a mode that differed from the recorded one in the current experiment
+};
+
+#endif
@@ -0,0 +1,65 @@
+/*!
+ * \file vector_env.h
+ *
+ * \brief defines a batch of independent environments that are solved in lockstep
+ *
+ */
+
+#include "rl_definitions.h"
+
+#ifndef __VECTOR_ENV__
+#define __VECTOR_ENV__
+
+/*!
+ * \class vector_env vector_env.h
+ * \brief holds a batch of independent copies of the environment, one for each episode
+ *
+ * All the copies are built from the environment created through the configuration manager,
+ * so that they share the same parameters, but each copy keeps its own state. The batch is
+ * used by the classifier system to match all the current inputs against [P] in one pass.
+ * \sa xcs_classifier_system::step(vector_env&, const bool, const bool)
+ */
+class vector_env
+{
+public:
+	//! name of the class that implements the batch of environments
+	string class_name() const { return string("vector_env"); };
+
+	//! class constructor; it creates size copies of environment
+	vector_env(const t_environment& environment, unsigned long size);
+
+	//! number of episodes in the batch
+	unsigned long size() const { return environments.size(); };
+
+	//! access the environment of episode i
+	t_environment& operator[](unsigned long i) { return environments[i]; };
+	const t_environment& operator[](unsigned long i) const { return environments[i]; };
+
+	//! begins a new problem in every episode
+	void begin_problem(const bool explore);
+
+	//! ends the current problem in every episode
+	void end_problem();
+
+	//! returns the current state of every episode
+	void states(vector<t_state>& inputs) const;
+
+	//! performs actions[i] in episode i
+	void perform(const vector<t_action>& actions);
+
+	//! returns the current reward of every episode
+	void rewards(vector<double>& rewards) const;
+
+	//! returns true if episode i has ended
+	bool stop(unsigned long i) const { return environments[i].stop(); };
+
+	//! returns true if all the episodes have ended
+	bool stop() const;
+
+	//! returns true if the environment implements a single-step problem
+	bool single_step() const { return environments.front().single_step(); };
+
+private:
+	vector<t_environment>	environments;		//!< one environment for each episode
+};
+#endif
@@ -56,6 +56,33 @@ public:
 	//! indicates that woods environments are multiple step problems
 	virtual bool single_step() const {return false;};
 
+	/**
+	 * methods to access the model of the environment, e.g., to compute the optimal action-value function
+	 */
+	//@{
+
+	//! number of positions the agent can occupy; the first start_positions() are free, the others contain food
+	unsigned long positions() const { return env_positions; };
+
+	//! number of free positions, i.e., the positions where a problem can start
+	unsigned long start_positions() const { return env_free_pos; };
+
+	//! number of moves available in each position
+	unsigned long moves() const { return no_moves; };
+
+	//! position reached from position pos with move act when the agent does not slip
+	unsigned long transition(const unsigned long pos, const unsigned long act) const { return next_position[pos*no_moves+act]; };
+
+	//! reward received in position pos
+	double reward(const unsigned long pos) const { return position_reward[pos]; };
+
+	//! sensory inputs perceived in position pos
+	const string& sensors(const unsigned long pos) const { return position_inputs[pos]; };
+
+	//! probability that the agent slips to one of the two moves adjacent to the selected one
+	double slide_probability() const { return prob_slide; };
+	//@}
+
  public:
 	virtual double reward() const {assert(current_reward==woods_env::current_reward); return current_reward;};
 	virtual t_state state() const { return inputs; };
@@ -68,9 +95,12 @@ public:
 	//! computes the sensory inputs that are returned in position <x,y>
 	void		get_input(const unsigned long x, const unsigned long y, t_state& sensors) const;
 
-	//! given the current <x,y> position sets the current input and the current reward \sa current_position_x \sa current_position_y
+	//! given the current position sets the current input and the current reward \sa current_position
 	inline void	set_state();
 
+	//! builds the position, sensor, transition, and reward tables from the map
+	void		build_tables();
+
 	//! return true if the position <x,y> is free (i.e., it contains ".")
 	inline bool	is_free(const unsigned long x, const unsigned long y) const;
 
@@ -110,9 +140,6 @@ public:
 	//! \var current_state current agent's input
 	//unsigned long	current_state;				// counter for the scan of states
 
-	//! \var configurations stores all the possible input configurations
-	vector<string>	configurations;				// configurations
-
         //! current x position in the environment
 	unsigned long 	current_pos_x;
         //! current y position in the environment
@@ -136,11 +163,32 @@ public:
         //! \var env_free_pos number of free positions (i.e., ".") in the environment
 	unsigned long 		env_free_pos;
 
-        //! x coordinates of the free positions in the environment
-	vector<unsigned long>	free_pos_x;
+        //! number of positions the agent can occupy, i.e., the free positions followed by the food positions
+	unsigned long		env_positions;
+
+        //! current position of the agent as an index in the position tables
+	unsigned long		current_position;
+
+        //! x coordinates of the positions in the environment; the first env_free_pos are free, the others contain food
+	vector<unsigned long>	position_x;
 	
-        //! y coordinates of the free positions in the environment
-	vector<unsigned long>	free_pos_y;
+        //! y coordinates of the positions in the environment
+	vector<unsigned long>	position_y;
+
+        //! maps the map cell y*env_columns+x to its position index, or to env_positions for obstacles
+	vector<unsigned long>	cell_position;
+
+        //! sensory inputs perceived in each position
+	vector<string>		position_inputs;
+
+        //! reward received in each position
+	vector<double>		position_reward;
+
+        //! next position for each position and action, stored at position*no_moves+action
+	vector<unsigned long>	next_position;
+
+        //! number of moves available to the agent, i.e., the eight adjacent cells
+	static const unsigned long no_moves = 8;
 
 	//! path traces the path the agent followed during the problem
 	string			path;
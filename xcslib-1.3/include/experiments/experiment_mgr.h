@@ -15,6 +15,18 @@
 #include "xcs_definitions.h"
 #include "xcs_random.h"
 #include "xcs_configuration_manager.h"
+#include "vector_env.h"
+#include "latency_histogram.h"
+#include "xcs_memory_usage.h"
+#include "xcs_event_trace.h"
+#include "xcs_metrics.h"
+#include "xcs_interaction_stream.h"
+#include <thread>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <list>
+#include <deque>
 
 #ifndef __EXPERIMENT_MGR__
 #define __EXPERIMENT_MGR__
@@ -47,6 +59,9 @@ public:
 	//! class constructor; it reads the class parameters through the configuration manager
 	experiment_mgr(xcs_configuration_manager &xcs_config, t_classifier_system *xcs, t_environment *environment, bool verbose=true);
 
+	//! class destructor; it waits for the action-value function being saved in background and only logs the error of the writer, since it cannot exit
+	~experiment_mgr();
+
 	//! set the parameters from the configuration file
 	void set_parameters(xcs_configuration_manager & xcs_config);
 
@@ -87,6 +102,10 @@ private:
 
 	unsigned long	current_no_test_problems;	//!< number of test problems solved so far
 
+	latency_histogram	learning_latency;	//!< wall-clock time of the learning problems of the current experiment
+	latency_histogram	testing_latency;	//!< wall-clock time of the test problems of the current experiment
+	unsigned long		experiment_steps;	//!< steps performed in the learning and test problems of the current experiment
+
 	bool	flag_save_experiment_final_state;		//!< true if the state of the system will be saved at the end of the experiment
 	long	save_experiment_interval;	//! the experiment status is saved every "save_interval" problems
 
@@ -96,7 +115,28 @@ private:
 	bool	flag_trace;					//!< true if the experiment outputs on the trace file
 	bool	flag_test_environment;		//!< true if the system will be tested on the whole environment
 	bool	flag_save_time_report;		//!< true if execution time is traced
+	bool	flag_population_statistics;	//!< true if the statistics of [P] are added to each line of the statistics file \sa xcs_classifier_system::statistics
+	bool	flag_event_trace;			//!< true if the timed events are saved in events.<ext>-<first experiment>.json \sa xcs_event_trace
+	unsigned long	event_trace_step_interval;	//!< one step every event_trace_step_interval is traced, none if zero
+	bool	flag_live_metrics;			//!< true if the progress is served on the socket metrics.<ext>.sock \sa xcs_metrics
+
+	xcs_metrics	metrics;				//!< server of the live metrics
+
+	bool	flag_record_stream;			//!< true if the interaction with the environment is saved in stream.<ext>-<first experiment>.bin \sa xcs_interaction_stream
+	xcs_interaction_stream	stream;		//!< log of the interaction with the environment
 	bool	flag_save_avf; 				//!< true if saves the action-value function
+	bool	flag_freeze_population;		//!< true if [P] is compiled into a frozen population to save the action-value function
+	bool	flag_verify_frozen_population;	//!< true if the frozen population is checked against [P] before it is used, for debugging
+	bool	flag_binary_avf;			//!< true if the action-value function is saved in binary format instead of compressed text
+	unsigned long	no_threads;			//!< number of threads used to evaluate snapshots of [P], all the hardware threads if zero
+
+	std::thread	avf_writer;				//!< thread that saves the action-value function in background
+	string		avf_error;				//!< error met by avf_writer, reported by wait_avf on the calling thread
+
+	bool	flag_parallel_test_environment;	//!< true if the test of the whole environment is performed by several threads on a copy of [P]
+
+	bool	flag_concurrent_test;		//!< true if test problems are solved by other threads on a snapshot of [P] while learning goes on
+	unsigned long	test_snapshot_interval;	//!< number of problems after which a new snapshot of [P] is taken for the test problems
 
 	string		extension;			//!< file extension for the experiment files
 	
@@ -108,8 +148,53 @@ private:
 
 	unsigned long teletransportation_interval;	//! number of steps between teletransportation
 
+	unsigned long batch_size;			//! number of problems solved in lockstep; if one, problems are solved one by one
+
 	t_classifier_system *xcs;
 	t_environment *environment;
+	vector_env *environments;			//! copies of the environment used to solve a batch of problems
+
+	//! throughput of an experiment and summary of its final population
+	struct t_throughput {
+		unsigned long	steps;				//!< steps performed while solving the problems
+		unsigned long	problems;			//!< learning and test problems solved
+		long			peak_rss;			//!< peak resident set size of the process at the end of the experiment, in KB
+		uint64_t		fingerprint;		//!< fingerprint of the final population \sa xcs_classifier_system::fingerprint
+	};
+
+	//! a test problem solved on a snapshot of [P]
+	struct t_test_problem {
+		unsigned long	problem;			//!< problem number
+		unsigned long	seed;				//!< seed of the random number generator used to solve the problem
+		unsigned long	population_size;	//!< size of [P] when the problem was scheduled
+		xcs_statistics	statistics;			//!< statistics of [P] when the problem was scheduled
+		long			steps;				//!< number of steps needed to solve the problem
+		double			reward_sum;			//!< sum of rewards gained while solving the problem
+		double			system_error;		//!< system error of the last step, for single step environments
+		string			trace;				//!< trace information from the environment
+		uint64_t		latency;			//!< wall-clock time spent solving the problem in nanoseconds
+	};
+
+	//! test problems that share the same snapshot of [P]; they are solved one by one by a worker thread
+	struct t_test_batch {
+		shared_ptr<population_snapshot>	snapshot;		//!< snapshot of [P]
+		shared_ptr<t_environment>		environment;	//!< copy of the environment used by the worker
+		vector<t_test_problem>			problems;		//!< problems of the batch
+		std::thread						worker;			//!< thread that solves the problems, not joinable until the batch is started
+		std::atomic<bool>				done;			//!< true once all the problems are solved
+	};
+
+	//! a line of the statistics and trace files that must wait for the test problems before it
+	struct t_pending_output {
+		t_test_batch	*batch;			//!< batch of the test problem, NULL if the line is already known
+		unsigned long	index;			//!< index of the test problem in the batch
+		string			statistics;		//!< line of the statistics file
+		string			trace;			//!< line of the trace file
+	};
+
+	std::list<t_test_batch>			test_batches;		//!< batches whose lines are not written yet; the last one is still collecting problems if not started
+	std::deque<t_pending_output>	pending_output;		//!< lines not written yet, in problem order
+	unsigned long					snapshot_problem;	//!< problem at which the last snapshot was taken
 
 	//================================================================================
 	//
@@ -126,11 +211,63 @@ private:
 	//! save the agent state for experiment \emph expNo
 	void save_population(const unsigned long expNo, const unsigned long problem_no=0) const;
 
-	//! save time report
-	void save_time_report(timer &timer_overall, std::vector<double> &experiment_time, std::vector<double> &problem_time);
+	//! save time report, with the wall-clock times, the latency of the problems, and the throughput of each experiment
+	void save_time_report(timer &timer_overall, std::vector<double> &experiment_time, std::vector<double> &problem_time, wall_timer &wall_overall, std::vector<double> &experiment_wall_time, std::vector<latency_histogram> &experiment_learning_latency, std::vector<latency_histogram> &experiment_testing_latency, std::vector<t_throughput> &experiment_throughput, std::vector<xcs_memory_usage> &experiment_memory);
+
+	//! append the time spent in each phase of the steps of experiment expNo to its report file
+	void save_profile_report(const unsigned long expNo) const;
+
+	//! save action value function; the states are evaluated on a snapshot of [P] in background
+	void save_avf(const unsigned long expNo, const unsigned long problem_no=0);
+
+	//! begin a problem of the environment and, if required, record it with the random numbers that the environment has drawn
+	void begin_environment_problem(const bool exploration);
+
+	//! wait until the action value function being saved in background is written, and report the error met by the writer if any
+	void wait_avf();
+
+	//! type of the functions that predict a batch of states, \sa xcs_classifier_system::predict(const vector<t_state>&, vector<double>&, vector<bool>&) const
+	typedef std::function<void (const vector<t_state>&, vector<double>&, vector<bool>&)> t_predictor;
+
+	//! returns a predictor on a copy of [P], frozen when required; if required, a frozen population is checked against [P] on states
+	t_predictor population_predictor(const vector<t_state>& states) const;
+
+	//! returns the action with the highest prediction, ties are broken randomly; a random action is returned if no action is matched
+	static unsigned long greedy_action(const vector<double>& prediction, const vector<bool>& matched, const unsigned long no_actions);
+
+	//! evaluates the states in chunks on a pool of threads
+	static void parallel_predict(const t_predictor& predictor, const unsigned long no_actions, const vector<t_state>& states, const unsigned long no_threads, vector<double>& prediction, vector<bool>& matched);
+
+	//! solve the next batch of problems in lockstep starting from current_problem; it returns the number of problems solved
+	/*!
+	 * each line of the statistics reports [P] as it was when its problem ended, while the
+	 * intermediate experiment states and populations are saved once per batch \sa save_intermediate
+	 */
+	unsigned long perform_problem_batch(ofstream &STATISTICS, ofstream &TRACE, bool &flag_exploration, double &problem_time);
+
+	//! test the greedy policy of [P] from every initial configuration of the environment using a pool of threads
+	void perform_parallel_test_environment(ofstream &STATISTICS, ofstream &TRACE);
+
+	//! schedule test problem problem_no on the last snapshot of [P], a new snapshot is taken every test_snapshot_interval problems
+	void add_test_problem(const unsigned long problem_no);
+
+	//! queue the lines of a problem solved by the classifier system after the test problems scheduled so far
+	void add_output(const string& statistics, const string& trace, ofstream &STATISTICS, ofstream &TRACE);
+
+	//! write the lines whose test problems are solved; if flag_wait is true, all the test problems are completed first
+	void flush_output(ofstream &STATISTICS, ofstream &TRACE, const bool flag_wait);
+
+	//! start the worker thread of a batch of test problems, at most no_threads batches run at the same time
+	void start_test_batch(t_test_batch &batch);
+
+	//! solve the problems of a batch greedily on its snapshot; it runs on the worker thread of the batch
+	void solve_test_batch(t_test_batch &batch) const;
 
-	//! save action value function 
-	void save_avf(const unsigned long expNo, const unsigned long problem_no=0) const;
+	//! save the intermediate experiment state and population after problem_no when it is required
+	/*!
+	 * \param no_problems number of problems that ended with problem_no, e.g., the problems of a batch; the state is saved if one of them requires it
+	 */
+	void save_intermediate(const unsigned long problem_no, const bool flag_exploration, const unsigned long no_problems=1) const;
 
 };
 #endif
@@ -36,6 +36,9 @@ public:
 	//! set the value of the state from a string
 	string string_value() const { return value; };
 
+	//! return the string of the state without copying it, e.g., to match many conditions against it
+	const string& string_reference() const { return value; };
+
 	//! set the value of the state from a string
 	void set_string_value(const string &str);
 
@@ -0,0 +1,129 @@
+/*!
+ * \file logic_minimizer.h
+ *
+ * \brief two-level logic minimization of ternary covers
+ *
+ */
+
+#ifndef __LOGIC_MINIMIZER__
+#define __LOGIC_MINIMIZER__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*!
+ * \class logic_minimizer logic_minimizer.h
+ * \brief computes a minimal set of ternary conditions that covers a set of input configurations
+ *
+ * The minimizer follows the expand, irredundant, and reduce loop of espresso on single output
+ * functions that are specified by an ON-set and an OFF-set; all the configurations that do not
+ * belong to any of the two sets are don't cares. Since only the configurations actually visited
+ * need to be listed, the cost depends on the number of listed configurations and not on 2^n.
+ *
+ * Cubes are packed in two 64 bit words, thus at most 64 inputs are supported.
+ */
+class logic_minimizer
+{
+public:
+	//! name of the class that implements the minimizer
+	string class_name() const { return string("logic_minimizer"); };
+
+	/*!
+	 * \brief a cube, i.e., a ternary condition, packed in two words
+	 *
+	 * bit i of care is set when input i is specified; in that case bit i of value is its value,
+	 * otherwise bit i of value is zero. Input i is the i-th character of the condition string.
+	 */
+	struct t_cube {
+		uint64_t	care;		//!< specified inputs
+		uint64_t	value;		//!< values of the specified inputs
+
+		bool operator==(const t_cube& cube) const { return (care==cube.care) && (value==cube.value); };
+		bool operator<(const t_cube& cube) const { return (care<cube.care) || ((care==cube.care) && (value<cube.value)); };
+	};
+
+	//! class constructor for functions of no_inputs inputs
+	logic_minimizer(const unsigned long no_inputs);
+
+	//! number of inputs
+	unsigned long inputs() const { return no_inputs; };
+
+	//! convert a string of 0, 1, and don't care symbols (i.e., '#', '-', or '2') into a cube
+	t_cube cube(const string& condition) const;
+
+	//! convert a cube into a condition string using dont_care as don't care symbol
+	string cube_string(const t_cube& cube, const char dont_care='#') const;
+
+	//! convert a cover into conditions, e.g., ternary_condition
+	template <class t_condition_class>
+	void conditions(const vector<t_cube>& cover, vector<t_condition_class>& conditions) const
+	{
+		conditions.clear();
+		for(vector<t_cube>::const_iterator cube=cover.begin(); cube!=cover.end(); cube++)
+		{
+			t_condition_class condition;
+			condition.set_string_value(cube_string(*cube));
+			conditions.push_back(condition);
+		}
+	};
+
+	//! computes a minimal cover of on_set that does not intersect off_set
+	void minimize(const vector<t_cube>& on_set, const vector<t_cube>& off_set, vector<t_cube>& cover) const;
+
+	//! minimizes a partition of the input configurations
+	/*!
+	 * \param partition the configurations that belong to each element of the partition, e.g., the configurations with the same payoff for one action
+	 * \param off_set configurations that must not be covered by any element of the partition; it can be empty
+	 * \param covers one cover for each element of the partition
+	 *
+	 * each element is minimized using the configurations of all the other elements and off_set as OFF-set
+	 */
+	void minimize(const vector< vector<t_cube> >& partition, const vector<t_cube>& off_set, vector< vector<t_cube> >& covers) const;
+
+	//! true if cube first contains cube second
+	static bool contains(const t_cube& first, const t_cube& second)
+	{
+		return ((first.care & ~second.care)==0) && (((first.value ^ second.value) & first.care)==0);
+	};
+
+	//! true if the two cubes have at least one configuration in common
+	static bool intersects(const t_cube& first, const t_cube& second)
+	{
+		return ((first.value ^ second.value) & first.care & second.care)==0;
+	};
+
+	//! smallest cube that contains both cubes
+	static t_cube merge(const t_cube& first, const t_cube& second)
+	{
+		t_cube	supercube;
+
+		supercube.care = first.care & second.care & ~(first.value ^ second.value);
+		supercube.value = first.value & supercube.care;
+		return supercube;
+	};
+
+private:
+	unsigned long	no_inputs;		//!< number of inputs
+
+	//! maximum number of expand, irredundant, and reduce iterations
+	static const unsigned long max_iterations = 20;
+
+	//! bit used for input i
+	uint64_t input_bit(const unsigned long i) const { return 1ULL << (no_inputs-1-i); };
+
+	//! expands the cubes in the cover into prime implicants; cubes contained in the expanded ones are removed
+	void expand(vector<t_cube>& cover, const vector<t_cube>& on_set, const vector<t_cube>& off_set) const;
+
+	//! expands one cube trying to cover as many of the uncovered cubes in on_set as possible
+	void expand_cube(t_cube& cube, const vector<t_cube>& on_set, const vector<bool>& covered, const vector<t_cube>& off_set) const;
+
+	//! removes the cubes that are not needed to cover on_set
+	void irredundant(vector<t_cube>& cover, const vector<t_cube>& on_set) const;
+
+	//! shrinks each cube to the smallest cube that contains the part of on_set it covers alone
+	void reduce(vector<t_cube>& cover, const vector<t_cube>& on_set) const;
+};
+#endif
@@ -0,0 +1,92 @@
+/*!
+ * \file minimization_scheduler.h
+ *
+ * \brief runs independent minimizations on a pool of threads with a cache of the computed covers
+ *
+ */
+
+#ifndef __MINIMIZATION_SCHEDULER__
+#define __MINIMIZATION_SCHEDULER__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "logic_minimizer.h"
+
+using namespace std;
+
+/*!
+ * \class minimization_scheduler minimization_scheduler.h
+ * \brief minimizes a set of independent functions, e.g., one for each action and payoff level
+ *
+ * The functions are added as jobs and minimized by run() on a pool of threads; each thread
+ * takes the next job not yet started, thus long and short jobs are balanced automatically.
+ *
+ * When a cache directory is given, each cover is saved in a file named after a hash of the
+ * ON-set and OFF-set of its function; a job whose function is already in the cache is not
+ * minimized again, thus when a map or a seed is run again only the functions that changed are
+ * recomputed. The sizes of the two sets are also saved and checked to guard against collisions.
+ */
+class minimization_scheduler
+{
+public:
+	//! name of the class that implements the scheduler
+	string class_name() const { return string("minimization_scheduler"); };
+
+	/*!
+	 * \brief class constructor
+	 * \param no_inputs number of inputs of the functions
+	 * \param no_threads number of threads, if zero the number of hardware threads is used
+	 * \param cache_directory directory of the cache, no cache is used if empty
+	 */
+	minimization_scheduler(const unsigned long no_inputs, const unsigned long no_threads=0, const string& cache_directory="");
+
+	//! adds the minimization of a function; returns the job index used to access its cover
+	unsigned long add(const vector<logic_minimizer::t_cube>& on_set, const vector<logic_minimizer::t_cube>& off_set);
+
+	//! minimizes all the functions added so far
+	void run();
+
+	//! number of jobs
+	unsigned long size() const { return jobs.size(); };
+
+	//! cover computed for job
+	const vector<logic_minimizer::t_cube>& cover(const unsigned long job) const { return jobs[job].cover; };
+
+	//! number of jobs whose cover has been read from the cache
+	unsigned long cached() const { return no_cached; };
+
+	//! the minimizer used by the scheduler
+	const logic_minimizer& minimizer() const { return logic; };
+
+	//! hash of a function, i.e., of its ON-set and OFF-set regardless of the order of the cubes
+	static uint64_t hash(const vector<logic_minimizer::t_cube>& on_set, const vector<logic_minimizer::t_cube>& off_set);
+
+private:
+	//! a function to be minimized
+	struct t_job {
+		vector<logic_minimizer::t_cube>	on_set;		//!< ON-set
+		vector<logic_minimizer::t_cube>	off_set;	//!< OFF-set
+		vector<logic_minimizer::t_cube>	cover;		//!< computed cover
+		bool							cached;		//!< true if the cover has been read from the cache
+	};
+
+	logic_minimizer		logic;				//!< minimizer
+	unsigned long		no_threads;			//!< number of threads
+	string				cache_directory;	//!< cache directory, empty if the cache is not used
+	vector<t_job>		jobs;				//!< jobs
+	unsigned long		no_cached;			//!< number of covers read from the cache
+
+	//! minimizes one job, reading or writing its cover in the cache
+	void minimize(t_job& job) const;
+
+	//! name of the cache file of a function
+	string cache_file(const t_job& job) const;
+
+	//! reads the cover of a job from the cache; returns false if it is not available
+	bool load(t_job& job) const;
+
+	//! saves the cover of a job in the cache
+	void save(const t_job& job) const;
+};
+#endif
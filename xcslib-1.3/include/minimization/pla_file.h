@@ -0,0 +1,63 @@
+/*!
+ * \file pla_file.h
+ *
+ * \brief reads and writes truth tables in the PLA format used by espresso
+ *
+ */
+
+#ifndef __PLA_FILE__
+#define __PLA_FILE__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "logic_minimizer.h"
+
+using namespace std;
+
+/*!
+ * \class pla_file pla_file.h
+ * \brief a multiple output truth table in the PLA format
+ *
+ * Each row contains an input cube and one symbol for each output: '1' if the cube belongs
+ * to the ON-set of the output, '0' if it belongs to the OFF-set, and '-' (or '~') if it is
+ * a don't care. As in the espresso type fr, the configurations not listed are don't cares;
+ * thus the complete tables (e.g., woods1q_a011_complete.pla) and the tables with only the
+ * visited configurations (e.g., woods1q_a011.pla) define the same functions.
+ */
+class pla_file
+{
+public:
+	//! name of the class
+	string class_name() const { return string("pla_file"); };
+
+	unsigned long		no_inputs;		//!< number of inputs
+	unsigned long		no_outputs;		//!< number of outputs
+	string				input_labels;	//!< input labels (.ilb), if any
+	vector<string>		output_labels;	//!< output labels (.olb), if any
+
+	vector<string>		inputs;			//!< input part of the rows
+	vector<string>		outputs;		//!< output part of the rows
+
+	//! class constructor for an empty table
+	pla_file() { no_inputs = 0; no_outputs = 0; };
+
+	//! reads a table from a stream
+	void read(istream& input);
+
+	//! writes the table to a stream
+	void write(ostream& output) const;
+
+	//! adds a row
+	void add(const string& input, const string& output) { inputs.push_back(input); outputs.push_back(output); };
+
+	//! returns the ON-set and the OFF-set of an output as cubes
+	void sets(const logic_minimizer& minimizer, const unsigned long output, vector<logic_minimizer::t_cube>& on_set, vector<logic_minimizer::t_cube>& off_set) const;
+
+	//! builds the table of the minimized function, each cover i becomes a set of rows for output i
+	void set_covers(const logic_minimizer& minimizer, const vector< vector<logic_minimizer::t_cube> >& covers);
+
+	//! payoff associated to an output, read from its label (e.g., p700 is 700)
+	double payoff(const unsigned long output) const;
+};
+#endif
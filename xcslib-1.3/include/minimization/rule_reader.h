@@ -0,0 +1,81 @@
+/*!
+ * \file rule_reader.h
+ *
+ * \brief reads (condition, action, payoff) triples from populations, solutions, and action-value functions
+ *
+ */
+
+#ifndef __RULE_READER__
+#define __RULE_READER__
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+using namespace std;
+
+/*!
+ * \class rule_reader
+ * \brief reads the (condition, action, payoff) triples of a population or action-value function file
+ *
+ * The file can be a population saved by XCS (id, condition, action, prediction, ...), a solution,
+ * an optimal population, or a Q-table (condition, action, payoff), or an action-value function
+ * saved by the experiment manager, either as text (State|a1|a2|...) or in the binary format
+ * (\sa experiment_mgr::save_avf); files ending with .gz are read through gzip, which is run
+ * without a shell, thus the file name is never interpreted.
+ */
+class rule_reader
+{
+public:
+	//! name of the class
+	string class_name() const { return string("rule_reader"); };
+
+	//! opens the file, .gz files are decompressed by gzip
+	rule_reader(const string& file_name);
+
+	//! closes the file
+	~rule_reader();
+
+	//! reads the next triple; returns false at the end of the file
+	bool next(string& condition, string& action, double& payoff);
+
+private:
+	rule_reader(const rule_reader&);
+	rule_reader& operator=(const rule_reader&);
+
+	string			file_name;		//!< name of the file
+	bool			compressed;		//!< true if the file is read through gzip
+	pid_t			decompressor;	//!< process of gzip that decompresses the file
+	FILE			*input;			//!< input stream
+	string			line;			//!< current line
+
+	string			pending;		//!< characters read before the first line
+
+	bool			avf;			//!< true if the file contains an action-value function
+	bool			binary;			//!< true if the action-value function is in binary format
+	uint32_t		no_inputs;		//!< number of inputs of the binary action-value function
+	uint64_t		no_states;		//!< number of states of the binary action-value function not read yet
+	vector<string>	actions;		//!< actions listed in the header of the action-value function
+	string			state;			//!< state of the current row of the action-value function
+	vector<string>	values;			//!< values of the current row of the action-value function
+	vector<string>	binary_actions;	//!< actions of the current binary state that are matched
+	unsigned long	current;		//!< next value of the current row
+
+	//! opens a pipe from gzip -dc run on the file
+	FILE* open_decompressed();
+
+	//! reads one line of any length
+	bool read_line();
+
+	//! reads the header of a binary action-value function
+	void read_binary_header();
+
+	//! reads the next state of a binary action-value function; the actions that no classifier matches are skipped
+	bool read_binary_state();
+
+	//! splits a string at separator
+	static void split(const string& str, const char separator, vector<string>& fields);
+};
+#endif
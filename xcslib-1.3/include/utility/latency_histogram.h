@@ -0,0 +1,99 @@
+/*!
+ * \file latency_histogram.h
+ *
+ * \brief records latencies in a histogram with bounded relative error
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+
+using namespace std;
+
+#ifndef __LATENCY_HISTOGRAM__
+#define __LATENCY_HISTOGRAM__
+
+/*!
+ * \class latency_histogram latency_histogram.h
+ * \brief histogram of latencies in nanoseconds with logarithmic buckets and linear sub-buckets
+ *
+ * As in HDR histograms, values below 2*sub_buckets are counted exactly, while larger values are
+ * grouped in buckets that cover the powers of two, each split in sub_buckets linear sub-buckets;
+ * thus the relative error of a reported percentile is below 1/sub_buckets whatever the latency,
+ * and recording a value takes constant time and memory. Minimum, maximum, and mean are exact.
+ */
+class latency_histogram
+{
+public:
+	//! name of the class that implements the histogram
+	string class_name() const { return string("latency_histogram"); };
+
+	//! number of bits of the linear sub-buckets
+	static const unsigned long sub_bucket_bits = 7;
+
+	//! number of linear sub-buckets of each power of two
+	static const uint64_t sub_buckets = 1ULL << sub_bucket_bits;
+
+	//! class constructor for an empty histogram
+	latency_histogram();
+
+	//! clear the histogram
+	void reset();
+
+	//! record one latency in nanoseconds
+	void record(const uint64_t value)
+	{
+		counts[index(value)]++;
+		no_values++;
+		sum += value;
+		if (value<minimum)
+			minimum = value;
+		if (value>maximum)
+			maximum = value;
+	};
+
+	//! add all the values recorded by another histogram
+	void merge(const latency_histogram& histogram);
+
+	//! number of values recorded
+	uint64_t count() const { return no_values; };
+
+	//! smallest value recorded, zero if empty
+	uint64_t min() const { return (no_values>0) ? minimum : 0; };
+
+	//! largest value recorded
+	uint64_t max() const { return maximum; };
+
+	//! average of the values recorded
+	double mean() const { return (no_values>0) ? sum/no_values : 0; };
+
+	//! smallest value such that at least the given percentage of the values is not larger
+	uint64_t percentile(const double percentage) const;
+
+	//! print count, mean, p50, p90, p99, and max in milliseconds, separated by tabs
+	void print(ostream& output) const;
+
+private:
+	//! index of the sub-bucket of value
+	static unsigned long index(const uint64_t value)
+	{
+		if (value<2*sub_buckets)
+			return value;
+
+		unsigned long	shift = (63-__builtin_clzll(value))-sub_bucket_bits;
+
+		return (shift+1)*sub_buckets + ((value >> shift) - sub_buckets);
+	};
+
+	//! largest value counted in sub-bucket index
+	static uint64_t highest_value(const unsigned long index);
+
+	vector<uint64_t>	counts;			//!< number of values in each sub-bucket
+	uint64_t			no_values;		//!< number of values recorded
+	double				sum;			//!< sum of the values recorded
+	uint64_t			minimum;		//!< smallest value recorded
+	uint64_t			maximum;		//!< largest value recorded
+};
+#endif
@@ -0,0 +1,157 @@
+/*!
+ * \file xcs_event_trace.h
+ *
+ * \brief records timed events of all the threads and saves them in the Chrome trace format
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+using namespace std;
+
+#ifndef __XCS_EVENT_TRACE__
+#define __XCS_EVENT_TRACE__
+
+/*!
+ * \class xcs_event_trace xcs_event_trace.h
+ * \brief process wide sink of timed events saved in the Chrome trace JSON format
+ *
+ * Each thread records its events in its own ring buffer, which has a single producer (the thread)
+ * and a single consumer (the writer); thus recording an event takes no lock and never waits. A
+ * background thread drains the buffers every few milliseconds and appends the events to the file,
+ * which can be loaded in chrome://tracing or in Perfetto; when a buffer is full the new events are
+ * dropped and counted. The buffers of the threads that end are reused by the threads that start
+ * later, thus short lived workers share the same few tracks.
+ *
+ * Timed events are saved as complete events, i.e., with their begin time and duration, so that a
+ * dropped event never leaves a begin without its end. Names, categories, and argument names must
+ * be string literals, since only their address is recorded.
+ *
+ * As for xcs_random, all the members are static; when the trace is not open, recording an event
+ * costs one relaxed atomic load.
+ */
+class xcs_event_trace
+{
+public:
+	//! name of the class that implements the trace
+	static string class_name() { return string("xcs_event_trace"); };
+
+	//! number of events each thread can record before the writer drains them
+	static const unsigned long buffer_size = 1UL << 16;
+
+	//! start tracing to file filename, one step every step_interval is traced (none if zero)
+	static void open(const string& filename, const unsigned long step_interval);
+
+	//! stop tracing, save the events still buffered, and close the file
+	static void close();
+
+	//! true if the events are recorded
+	static bool is_open() { return enabled.load(memory_order_relaxed); };
+
+	//! true if step number step must be traced
+	static bool sample_step(const unsigned long step) { return is_open() && (steps_interval>0) && (step%steps_interval==0); };
+
+	//! nanoseconds elapsed since the trace was opened
+	static uint64_t now();
+
+	//! record an event that started at start and ends now, with an optional integer argument
+	static void complete(const char *name, const char *category, const uint64_t start, const char *arg_name=NULL, const int64_t arg=0);
+
+	//! record an event without duration
+	static void instant(const char *name, const char *category, const char *arg_name=NULL, const int64_t arg=0);
+
+	/*!
+	 * \class span
+	 * \brief records an event from its construction to its destruction
+	 */
+	class span
+	{
+	public:
+		span(const char *name, const char *category, const char *arg_name=NULL, const int64_t arg=0, const bool flag_trace=true) : name(name), category(category), arg_name(arg_name), arg(arg), flag_record(flag_trace && is_open())
+		{
+			if (flag_record)
+				start = now();
+		};
+
+		~span()
+		{
+			if (flag_record)
+				complete(name, category, start, arg_name, arg);
+		};
+
+		//! set the argument of the event, e.g., when it is known only at the end
+		void set_argument(const int64_t value) { arg = value; };
+
+	private:
+		const char	*name;			//!< name of the event
+		const char	*category;		//!< category of the event
+		const char	*arg_name;		//!< name of the argument, NULL if none
+		int64_t		arg;			//!< value of the argument
+		bool		flag_record;	//!< true if the event is recorded
+		uint64_t	start;			//!< time at which the event started
+	};
+
+private:
+	//! an event recorded by a thread
+	struct t_event {
+		const char	*name;			//!< name of the event
+		const char	*category;		//!< category of the event
+		const char	*arg_name;		//!< name of the argument, NULL if none
+		int64_t		arg;			//!< value of the argument
+		uint64_t	start;			//!< time at which the event started
+		uint64_t	duration;		//!< duration of the event, ignored by instant events
+		char		phase;			//!< 'X' for complete events, 'i' for instant events
+	};
+
+	//! ring buffer of the events of one thread
+	struct t_buffer {
+		vector<t_event>			events;		//!< events recorded, buffer_size of them
+		atomic<uint64_t>		head;		//!< number of events recorded, written by the thread
+		atomic<uint64_t>		tail;		//!< number of events saved, written by the writer
+		atomic<uint64_t>		dropped;	//!< number of events dropped because the buffer was full
+		atomic<bool>			released;	//!< true when the thread has ended
+		unsigned long			tid;		//!< track of the buffer in the trace
+		bool					named;		//!< true if the name of the track has been saved
+	};
+
+	//! releases the buffer of a thread when the thread ends
+	struct t_owner {
+		t_buffer	*buffer;
+		~t_owner() { if (buffer!=NULL) buffer->released.store(true, memory_order_release); };
+	};
+
+	//! record event in the buffer of the calling thread
+	static void record(const t_event &event);
+
+	//! buffer of the calling thread, taken when it records its first event
+	static t_buffer* thread_buffer();
+
+	//! save the events recorded so far
+	static void drain();
+
+	//! body of the background thread
+	static void write();
+
+	static atomic<bool>					enabled;		//!< true if the trace is open
+	static unsigned long				steps_interval;	//!< one step every steps_interval is traced
+	static uint64_t						origin;			//!< time at which the trace was opened
+	static mutex						buffers_mutex;	//!< protects buffers
+	static vector<unique_ptr<t_buffer>>	buffers;		//!< buffers of all the threads, never freed while the trace is open
+	static FILE							*output;		//!< trace file
+	static bool							flag_first;		//!< true until the first event is saved
+	static thread						writer;			//!< thread that saves the events in background
+	static mutex						writer_mutex;	//!< protects flag_stop
+	static condition_variable			writer_wakeup;	//!< wakes the writer up when the trace is closed
+	static bool							flag_stop;		//!< true when the writer must end
+	static bool							flag_exit;		//!< true once close is registered to run at exit
+	static thread_local t_owner			owner;			//!< buffer of the calling thread
+};
+#endif
@@ -0,0 +1,126 @@
+/*!
+ * \file xcs_interaction_stream.h
+ *
+ * \brief records and reads the stream of states, actions, and rewards exchanged with the environment
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#ifndef __XCS_INTERACTION_STREAM__
+#define __XCS_INTERACTION_STREAM__
+
+/*!
+ * \class xcs_interaction_stream xcs_interaction_stream.h
+ * \brief compact binary log of the interaction between the classifier system and the environment
+ *
+ * The log begins with a header that contains the magic string XCSSTRM1, the seed of the run, the
+ * number of actions, and whether the environment is single step; then it contains one record per
+ * event, each one starting with a tag byte:
+ *  - 'E' an experiment begins: experiment number
+ *  - 'P' a problem begins: exploration flag byte, numbers drawn by the environment, size of the states in bits
+ *  - 'S' a step that does not end the problem, 'T' a step that ends it: the state read by the
+ *    classifier system packed eight inputs per byte, the action performed, the reward as a double,
+ *    and the numbers drawn by the environment to perform the action
+ *
+ * Numbers are saved as unsigned LEB128 varints and doubles in the byte order of the machine, thus
+ * a step of a 6-bit multiplexer takes 12 bytes. The numbers drawn from xcs_random by the environment
+ * let a replay skip them, so that the classifier system draws the same sequence as the recorded
+ * run. States are binary strings; any other input is an error.
+ *
+ * When read, the states are stored once each and the steps refer to them by index.
+ */
+class xcs_interaction_stream
+{
+public:
+	//! one step of a problem
+	struct t_step {
+		unsigned long		state;		//!< index of the state read by the classifier system in states
+		unsigned long		action;		//!< value of the action performed
+		double				reward;		//!< reward returned by the environment
+		bool				stop;		//!< true if the step ended the problem
+		unsigned long long	draws;		//!< random numbers drawn by the environment to perform the action
+	};
+
+	//! a problem, i.e., the steps between two calls to begin_problem of the environment
+	struct t_problem {
+		bool				exploration;	//!< true if the problem was solved in learning mode
+		unsigned long long	draws;			//!< random numbers drawn by the environment when the problem began
+		unsigned long		first_step;		//!< index of its first step in steps
+		unsigned long		no_steps;		//!< number of steps
+	};
+
+	//! an experiment
+	struct t_experiment {
+		unsigned long		number;			//!< number of the experiment in the recorded run
+		unsigned long		first_problem;	//!< index of its first problem in problems
+		unsigned long		no_problems;	//!< number of problems
+	};
+
+	//! name of the class that implements the stream
+	string class_name() const { return string("xcs_interaction_stream"); };
+
+	//! class constructor, no file is open
+	xcs_interaction_stream() : output(NULL), state_size(0), no_bytes(0) {};
+
+	//! class destructor, it closes the log being recorded
+	~xcs_interaction_stream() { close(); };
+
+	//! \name recording
+	//@{
+	//! create the log and write its header
+	void open(const string& filename, const unsigned long seed, const unsigned long no_actions, const bool single_step);
+
+	//! flush and close the log
+	void close();
+
+	//! true if a log is being recorded
+	bool is_open() const { return (output!=NULL); };
+
+	//! record the beginning of an experiment
+	void begin_experiment(const unsigned long experiment);
+
+	//! record the beginning of a problem, draws are the numbers drawn by the environment to begin it and state is its first state
+	void begin_problem(const bool exploration, const unsigned long long draws, const string& state);
+
+	//! record a step in which the classifier system read state and performed action
+	void step(const string& state, const unsigned long action, const double reward, const bool stop, const unsigned long long draws);
+
+	//! bytes written so far
+	unsigned long long size() const { return no_bytes; };
+	//@}
+
+	//! \name reading
+	//@{
+	//! read a whole log, any previous content is cleared
+	void read(const string& filename);
+
+	unsigned long			seed;			//!< seed of the recorded run
+	unsigned long			no_actions;		//!< number of actions of the recorded run
+	bool					single_step;	//!< true if the recorded environment was single step
+
+	vector<string>			states;			//!< distinct states of the log
+	vector<t_step>			steps;			//!< steps of all the problems
+	vector<t_problem>		problems;		//!< problems of all the experiments
+	vector<t_experiment>	experiments;	//!< experiments
+	//@}
+
+private:
+	xcs_interaction_stream(const xcs_interaction_stream&);
+	xcs_interaction_stream& operator=(const xcs_interaction_stream&);
+
+	void write_byte(const unsigned char value);
+	void write_number(unsigned long long value);
+	void write_state(const string& state);
+
+	FILE				*output;		//!< log being recorded
+	unsigned long		state_size;		//!< size of the states of the current problem
+	unsigned long long	no_bytes;		//!< bytes written
+	vector<unsigned char>	packed;		//!< buffer used to pack the states
+};
+#endif
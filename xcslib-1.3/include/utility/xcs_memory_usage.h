@@ -0,0 +1,120 @@
+/*!
+ * \file xcs_memory_usage.h
+ *
+ * \brief accounts the memory taken by the classifiers and by the sets of the classifier system
+ *
+ */
+
+#include <ostream>
+#include <string>
+
+using namespace std;
+
+#ifndef __XCS_MEMORY_USAGE__
+#define __XCS_MEMORY_USAGE__
+
+/*!
+ * \class xcs_memory_usage xcs_memory_usage.h
+ * \brief bytes of the classifiers in [P], their allocations, and the size of [P], [M], and [A]
+ *
+ * The classifier system reports every classifier it allocates or frees with its footprint, i.e.,
+ * the classifier object plus the heap blocks of its condition and action; thus the live bytes are
+ * the bytes of [P] and the churn is the number of classifiers allocated and freed. The sizes of
+ * [P] are sampled when classifiers are inserted, those of [M] and [A] at each step; the bytes of
+ * [M] and [A] are estimated from the average footprint of the classifiers in [P]. The vectors of
+ * pointers that implement the sets are accounted separately by their capacity. The overhead of
+ * the allocator is not counted.
+ */
+class xcs_memory_usage
+{
+public:
+	//! name of the class that implements the accounting
+	string class_name() const { return string("xcs_memory_usage"); };
+
+	//! class constructor, no classifier is allocated
+	xcs_memory_usage() : live_bytes(0), live_classifiers(0) { reset(); };
+
+	//! clear the peaks and the churn; the classifiers still allocated stay accounted
+	void reset();
+
+	//! account a classifier of bytes allocated
+	void allocate(const unsigned long bytes)
+	{
+		no_allocations++;
+		allocated_bytes += bytes;
+		live_classifiers++;
+		live_bytes += bytes;
+		if (live_bytes>peak_bytes)
+			peak_bytes = live_bytes;
+	};
+
+	//! account a classifier of bytes freed
+	void release(const unsigned long bytes)
+	{
+		no_releases++;
+		live_classifiers--;
+		live_bytes -= bytes;
+	};
+
+	//! sample the size of [P] in macro and micro classifiers
+	void population(const unsigned long macro_size, const unsigned long micro_size)
+	{
+		if (macro_size>peak_macro)
+			peak_macro = macro_size;
+		if (micro_size>peak_micro)
+			peak_micro = micro_size;
+	};
+
+	//! sample the number of macro classifiers in [M] and [A]
+	void sets(const unsigned long match_set_size, const unsigned long action_set_size)
+	{
+		no_samples++;
+		match_set_sum += match_set_size;
+		action_set_sum += action_set_size;
+		if (match_set_size>peak_match_set)
+			peak_match_set = match_set_size;
+		if (action_set_size>peak_action_set)
+			peak_action_set = action_set_size;
+	};
+
+	//! set the bytes reserved by the vectors that implement the sets of classifiers
+	void set_container_bytes(const unsigned long bytes) { container_bytes = bytes; };
+
+	//! bytes of the classifiers currently allocated
+	unsigned long bytes() const { return live_bytes; };
+
+	//! largest number of bytes of the classifiers allocated at the same time
+	unsigned long peak() const { return peak_bytes; };
+
+	//! average footprint of the classifiers currently allocated
+	double classifier_bytes() const { return (live_classifiers>0) ? double(live_bytes)/live_classifiers : 0; };
+
+	//! number of classifiers allocated
+	unsigned long allocations() const { return no_allocations; };
+
+	//! number of classifiers freed
+	unsigned long releases() const { return no_releases; };
+
+	//! print live and peak KB, bytes per classifier, peak macro and micro, churn, [M], [A], and the sets, separated by tabs
+	void print(ostream& output) const;
+
+	//! print the header of the columns written by print
+	static void print_header(ostream& output);
+
+private:
+	unsigned long	live_bytes;			//!< bytes of the classifiers currently allocated
+	unsigned long	live_classifiers;	//!< number of classifiers currently allocated
+	unsigned long	peak_bytes;			//!< largest value of live_bytes
+	unsigned long	peak_macro;			//!< largest number of macro classifiers in [P]
+	unsigned long	peak_micro;			//!< largest number of micro classifiers in [P]
+	unsigned long	no_allocations;		//!< number of classifiers allocated
+	unsigned long	no_releases;		//!< number of classifiers freed
+	unsigned long	allocated_bytes;	//!< bytes of the classifiers allocated
+	unsigned long	no_samples;			//!< number of steps in which [M] and [A] have been sampled
+	double			match_set_sum;		//!< sum of the sizes of [M]
+	double			action_set_sum;		//!< sum of the sizes of [A]
+	unsigned long	peak_match_set;		//!< largest [M]
+	unsigned long	peak_action_set;	//!< largest [A]
+	unsigned long	container_bytes;	//!< bytes reserved by the vectors of pointers of the sets
+};
+#endif
@@ -0,0 +1,131 @@
+/*!
+ * \file xcs_metrics.h
+ *
+ * \brief publishes the progress of a run on a local socket while the experiments go on
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <atomic>
+#include <thread>
+#include "xcs_profiler.h"
+
+using namespace std;
+
+#ifndef __XCS_METRICS__
+#define __XCS_METRICS__
+
+/*!
+ * \class xcs_metrics xcs_metrics.h
+ * \brief live metrics of a run served as JSON on a Unix domain socket by a background thread
+ *
+ * The experiment manager reports each problem it completes; the rolling averages and the rates
+ * are computed on its thread and the result is published as a snapshot protected by a sequence
+ * counter (seqlock), thus publishing never waits for the server, while the server copies the
+ * snapshot again if it was being published meanwhile. The snapshot is kept in atomic words, so
+ * that the concurrent copies are well defined.
+ *
+ * Any connection receives the current snapshot and is closed; if the request starts with GET the
+ * answer is an HTTP response, e.g., curl --unix-socket metrics.mp6.sock http://localhost/, otherwise
+ * it is the bare JSON document, e.g., nc -U metrics.mp6.sock < /dev/null.
+ */
+class xcs_metrics
+{
+public:
+	//! number of test problems over which reward, steps, and system error are averaged
+	static const unsigned long window = 50;
+
+	//! what the server reports
+	struct t_snapshot {
+		uint64_t	uptime_ns;					//!< time since the server started
+		uint64_t	experiment;					//!< current experiment
+		uint64_t	problem;					//!< last problem completed
+		uint64_t	exploration;				//!< 1 if the last problem was a learning problem
+		uint64_t	learning_problems;			//!< learning problems completed in the experiment
+		uint64_t	test_problems;				//!< test problems completed in the experiment
+		uint64_t	steps;						//!< steps performed in the experiment
+		double		steps_per_second;			//!< steps per second over the last second
+		double		problems_per_second;		//!< problems per second over the last second
+		uint64_t	macro_size;					//!< macro classifiers in [P]
+		uint64_t	micro_size;					//!< micro classifiers in [P]
+		uint64_t	no_window;					//!< test problems in the rolling window
+		double		rolling_reward;				//!< average reward of the test problems in the window
+		double		rolling_steps;				//!< average steps of the test problems in the window
+		double		rolling_system_error;		//!< average system error of the test problems in the window
+		double		learning_latency_ms;		//!< average wall-clock time of the learning problems
+		double		testing_latency_ms;			//!< average wall-clock time of the test problems
+		uint64_t	phase_calls[xcs_profiler::NO_PHASES];		//!< calls of each phase of the step
+		uint64_t	phase_self_ns[xcs_profiler::NO_PHASES];		//!< self time of each phase of the step
+		uint64_t	phase_inclusive_ns[xcs_profiler::NO_PHASES];	//!< inclusive time of each phase of the step
+	};
+
+	//! name of the class that implements the metrics
+	string class_name() const { return string("xcs_metrics"); };
+
+	//! class constructor, the server is not running
+	xcs_metrics();
+
+	//! class destructor, it stops the server
+	~xcs_metrics() { stop(); };
+
+	//! serve the metrics on the Unix domain socket path; return false, with a warning, if the socket cannot be created
+	bool start(const string& path);
+
+	//! stop the server and remove the socket
+	void stop();
+
+	//! true if the server is running
+	bool is_running() const { return running; };
+
+	//! clear the counters and the rolling window when experiment begins
+	void begin_experiment(const unsigned long experiment);
+
+	//! account one problem solved in steps steps with latency_ns wall-clock nanoseconds, and publish the new snapshot
+	void problem(const unsigned long problem_no, const bool exploration, const unsigned long steps, const double reward, const double system_error, const uint64_t latency_ns, const unsigned long macro_size, const unsigned long micro_size, const xcs_profiler& profiler);
+
+	//! copy the last snapshot published
+	void read(t_snapshot& snapshot) const;
+
+	//! print a snapshot as a JSON document
+	static void print(ostream& output, const t_snapshot& snapshot);
+
+private:
+	xcs_metrics(const xcs_metrics&);
+	xcs_metrics& operator=(const xcs_metrics&);
+
+	static const unsigned long	no_words = (sizeof(t_snapshot)+sizeof(uint64_t)-1)/sizeof(uint64_t);
+
+	//! copy current in the published words
+	void publish();
+
+	//! body of the server thread
+	void serve();
+
+	//! monotonic clock in nanoseconds
+	static uint64_t now() { return xcs_profiler::now(); };
+
+	//! state of the thread that reports the problems
+	//@{
+	t_snapshot		current;					//!< snapshot being built
+	uint64_t		start_ns;					//!< time at which the server started
+	uint64_t		rate_start_ns;				//!< start of the interval over which the rates are computed
+	uint64_t		rate_start_steps;			//!< steps performed at the start of the interval
+	uint64_t		rate_start_problems;		//!< problems completed at the start of the interval
+	double			learning_latency_sum;		//!< wall-clock time of the learning problems, in nanoseconds
+	double			testing_latency_sum;		//!< wall-clock time of the test problems, in nanoseconds
+	double			window_reward[window];		//!< reward of the last test problems
+	double			window_steps[window];		//!< steps of the last test problems
+	double			window_system_error[window];	//!< system error of the last test problems
+	//@}
+
+	atomic<uint64_t>	sequence;				//!< odd while a snapshot is being published
+	atomic<uint64_t>	words[no_words];		//!< snapshot published
+
+	string			socket_path;				//!< path of the Unix domain socket
+	int				socket_fd;					//!< listening socket
+	atomic<bool>	flag_stop;					//!< true when the server must end
+	bool			running;					//!< true if the server is running
+	std::thread		server;						//!< thread that answers the requests
+};
+#endif
@@ -0,0 +1,79 @@
+/*!
+ * \file xcs_perf_counters.h
+ *
+ * \brief reads the hardware performance counters of the calling thread through perf_event_open
+ *
+ */
+
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+#ifndef __XCS_PERF_COUNTERS__
+#define __XCS_PERF_COUNTERS__
+
+/*!
+ * \class xcs_perf_counters xcs_perf_counters.h
+ * \brief group of hardware counters of the calling thread, read with a single system call
+ *
+ * The counters are opened as one perf_event group led by the cycle counter, so that all of them
+ * are scheduled together and a single read returns all the values. Only user space is counted,
+ * which is what perf_event_paranoid allows to unprivileged users. When the system call is not
+ * available (e.g., in containers, or when the kernel refuses it) the group stays closed, read
+ * returns false, and reason explains why; events that the processor does not support are left
+ * out of the group and reported as unavailable.
+ */
+class xcs_perf_counters
+{
+public:
+	//! events counted
+	typedef enum {
+		EVENT_CYCLES,				//!< processor cycles
+		EVENT_INSTRUCTIONS,			//!< instructions retired
+		EVENT_L1D_MISSES,			//!< level 1 data cache read misses
+		EVENT_LLC_MISSES,			//!< last level cache misses
+		EVENT_BRANCH_MISSES,		//!< mispredicted branches
+		NO_EVENTS
+	} t_event;
+
+	//! name of the class that implements the counters
+	string class_name() const { return string("xcs_perf_counters"); };
+
+	//! class constructor, the counters are closed
+	xcs_perf_counters();
+
+	//! class destructor, it closes the counters
+	~xcs_perf_counters() { close(); };
+
+	//! open and start the counters of the calling thread; return false if they are not available
+	bool open();
+
+	//! close the counters
+	void close();
+
+	//! true if the counters are open
+	bool is_open() const { return (fd[EVENT_CYCLES]!=-1); };
+
+	//! true if event is counted
+	bool available(const t_event event) const { return (fd[event]!=-1); };
+
+	//! why the counters, or some of them, are not available
+	string reason() const { return why; };
+
+	//! store the current value of all the events in values, zero for those not available
+	bool read(uint64_t values[NO_EVENTS]) const;
+
+	//! name of an event
+	static string event_name(const t_event event);
+
+private:
+	xcs_perf_counters(const xcs_perf_counters&);
+	xcs_perf_counters& operator=(const xcs_perf_counters&);
+
+	int				fd[NO_EVENTS];			//!< file descriptor of each event, -1 if not available
+	unsigned long	position[NO_EVENTS];	//!< position of each event in the values read from the group
+	unsigned long	no_open;				//!< number of events in the group
+	string			why;					//!< reason why the counters are not available
+};
+#endif
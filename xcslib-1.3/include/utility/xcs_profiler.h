@@ -0,0 +1,177 @@
+/*!
+ * \file xcs_profiler.h
+ *
+ * \brief times and counts the phases of the steps performed by the classifier system
+ *
+ */
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <ostream>
+#include "xcs_perf_counters.h"
+
+using namespace std;
+
+#ifndef __XCS_PROFILER__
+#define __XCS_PROFILER__
+
+/*!
+ * \class xcs_profiler xcs_profiler.h
+ * \brief collects the time spent in each phase of xcs_classifier_system::step
+ *
+ * The phases are timed through scopes that are created by the macro XCS_PROFILE; since phases
+ * are nested (e.g., deletion inside the genetic algorithm), each phase accumulates both its
+ * inclusive time and its self time, i.e., the time not spent in the nested phases. The self time
+ * of the step phase is the time spent outside all the other phases.
+ *
+ * The phases selected with count_events are also measured with the hardware counters of
+ * xcs_perf_counters (cycles, instructions, cache and branch misses); the counters are inclusive,
+ * and since each of them costs two system calls per call, the time of the counted phases grows.
+ *
+ * The instrumentation is compiled only when __PROFILE__ is defined (e.g., make woods
+ * USERFLAGS=-D__PROFILE__), otherwise the macros expand to nothing and the profiler stays empty.
+ */
+class xcs_profiler
+{
+public:
+	//! phases of a step
+	typedef enum {
+		PHASE_STEP,					//!< the whole step
+		PHASE_MATCH,				//!< build [M]
+		PHASE_COVERING,				//!< covering loop, each iteration is counted
+		PHASE_PREDICTION_ARRAY,		//!< build the prediction array
+		PHASE_ACTION_SET,			//!< build [A]
+		PHASE_UPDATE,				//!< reinforcement component
+		PHASE_GA,					//!< genetic algorithm
+		PHASE_SUBSUMPTION,			//!< GA and action set subsumption
+		PHASE_DELETION,				//!< deletion from [P]
+		NO_PHASES
+	} t_phase;
+
+#ifdef __PROFILE__
+	static const bool enabled = true;	//!< true if the instrumentation is compiled
+#else
+	static const bool enabled = false;	//!< true if the instrumentation is compiled
+#endif
+
+	//! name of the class that implements the profiler
+	string class_name() const { return string("xcs_profiler"); };
+
+	//! class constructor
+	xcs_profiler();
+
+	//! clear the collected times and counters
+	void reset();
+
+	/*!
+	 * \brief measure the hardware events of phases, either "off", "all", or a comma separated list of phase names
+	 *
+	 * The counters are opened for the calling thread; return false if they are not available.
+	 */
+	bool count_events(const string& phases);
+
+	//! list of the phases whose hardware events are measured, "off" if none
+	string counted_phases() const;
+
+	//! why the hardware counters are not available
+	string counters_status() const { return counters.reason(); };
+
+	//! count one more iteration of phase (e.g., of the covering loop)
+	void count(const t_phase phase) { iterations[phase]++; };
+
+	//! number of times phase was timed
+	uint64_t calls(const t_phase phase) const { return no_calls[phase]; };
+
+	//! self time of phase in nanoseconds
+	uint64_t self_time(const t_phase phase) const { return self_ns[phase]; };
+
+	//! inclusive time of phase in nanoseconds
+	uint64_t inclusive_time(const t_phase phase) const { return inclusive_ns[phase]; };
+
+	//! hardware event counted in phase
+	uint64_t events(const t_phase phase, const xcs_perf_counters::t_event event) const { return event_count[phase][event]; };
+
+	//! name of a phase
+	static string phase_name(const t_phase phase);
+
+	//! print the times and the counters of all the phases, one for each line, then the hardware events of the counted phases
+	void print(ostream& output) const;
+
+	//! print the hardware events of the counted phases, one for each line
+	void print_events(ostream& output) const;
+
+	//! monotonic clock in nanoseconds
+	static uint64_t now() { return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count(); };
+
+	/*!
+	 * \class scope
+	 * \brief times a phase from its construction to its destruction
+	 */
+	class scope
+	{
+	public:
+		scope(xcs_profiler& profiler, const t_phase phase) : profiler(profiler), phase(phase), parent(profiler.active), nested_ns(0)
+		{
+			profiler.active = this;
+			if (profiler.counted[phase])
+				profiler.counters.read(start_events);
+			start = now();
+		};
+
+		~scope()
+		{
+			uint64_t	elapsed = now()-start;
+
+			if (profiler.counted[phase])
+			{
+				uint64_t	end_events[xcs_perf_counters::NO_EVENTS];
+
+				profiler.counters.read(end_events);
+				for(unsigned long event=0; event<xcs_perf_counters::NO_EVENTS; event++)
+					profiler.event_count[phase][event] += end_events[event]-start_events[event];
+			}
+
+			profiler.no_calls[phase]++;
+			profiler.inclusive_ns[phase] += elapsed;
+			profiler.self_ns[phase] += elapsed-nested_ns;
+			if (parent!=NULL)
+				parent->nested_ns += elapsed;
+			profiler.active = parent;
+		};
+
+	private:
+		xcs_profiler&	profiler;		//!< profiler that collects the time
+		t_phase			phase;			//!< phase timed
+		scope			*parent;		//!< scope of the enclosing phase, NULL if none
+		uint64_t		nested_ns;		//!< time spent in the nested phases
+		uint64_t		start;			//!< time at which the phase started
+		uint64_t		start_events[xcs_perf_counters::NO_EVENTS];	//!< hardware events at which the phase started
+	};
+
+private:
+	xcs_profiler(const xcs_profiler&);
+	xcs_profiler& operator=(const xcs_profiler&);
+
+	scope		*active;					//!< innermost phase being timed
+	uint64_t	no_calls[NO_PHASES];		//!< number of times each phase was timed
+	uint64_t	iterations[NO_PHASES];		//!< iterations counted for each phase
+	uint64_t	self_ns[NO_PHASES];			//!< self time of each phase
+	uint64_t	inclusive_ns[NO_PHASES];	//!< inclusive time of each phase
+
+	xcs_perf_counters	counters;		//!< hardware counters of the thread that performs the steps
+	bool		counted[NO_PHASES];			//!< true if the hardware events of the phase are measured
+	uint64_t	event_count[NO_PHASES][xcs_perf_counters::NO_EVENTS];	//!< hardware events of each phase
+};
+
+#ifdef __PROFILE__
+//! time the rest of the enclosing block as phase
+#define XCS_PROFILE(profiler, phase) xcs_profiler::scope xcs_profile_scope((profiler), xcs_profiler::phase)
+//! count one iteration of phase
+#define XCS_PROFILE_COUNT(profiler, phase) (profiler).count(xcs_profiler::phase)
+#else
+#define XCS_PROFILE(profiler, phase)
+#define XCS_PROFILE_COUNT(profiler, phase)
+#endif
+
+#endif
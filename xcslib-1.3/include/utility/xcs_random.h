@@ -20,12 +20,16 @@
 class xcs_random {
  private:
 	//!  \var unsigned long seed to initialize the random number generator
-	static unsigned long seed;
+	static thread_local unsigned long seed;
 
 	static std::random_device rd;
-	static std::mt19937_64 generator;
-	static std::uniform_real_distribution<> uniform_distribution;	
-	static std::normal_distribution<> normal_distribution;
+
+	//! each thread has its own generator, thus worker threads can draw numbers without locks once seeded
+	static thread_local std::mt19937_64 generator;
+	static thread_local std::uniform_real_distribution<> uniform_distribution;	
+	static thread_local std::normal_distribution<> normal_distribution;
+	//! numbers drawn from the generator by random, dice, sign, and bits since the seed was set
+	static thread_local unsigned long long no_draws;
 	const static std::vector<std::string> configuration_parameters;
  public:
 	xcs_random();
@@ -56,6 +60,19 @@ class xcs_random {
 	 */
 	static unsigned int dice(unsigned int limit);
 
+	//! returns 64 random bits with a single draw from the generator
+	static unsigned long long bits();
+	//! returns the seed set through the configuration manager, zero if the generator was seeded from the clock
+	static unsigned long get_seed() { return seed; };
+	/*! \brief returns the numbers drawn by random, dice, sign, and bits, one each; those drawn by nrandom are not counted
+	 *
+	 *  the difference between two calls tells how many numbers a piece of code has drawn, 
+	 *  thus a replay can skip them with discard and keep the rest of the sequence unchanged
+	 */
+	static unsigned long long draws() { return no_draws; };
+	//! skips the next n numbers of the sequence as if they had been drawn \sa draws
+	static void discard(const unsigned long long n) { generator.discard(n); no_draws += n; };
+
 	//! Saves the state of the random number generator to an output stream.
 	/*! 
 	 * It currently does not perform any action.
@@ -35,6 +35,9 @@ class xcs_statistics
 		//! reset all the collected statistics
 		void reset();
 
+		//! write the statistics of [P] as columns of the statistics files; the average number of updates is not collected, thus it is left out
+		void write_columns(ostream& output) const;
+
 		//! read the statistics from an output stream
 		friend istream& operator>>(istream&, xcs_statistics&);
 
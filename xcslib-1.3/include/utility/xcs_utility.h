@@ -85,6 +85,8 @@
 #include <ctime>
 #include <iomanip>
 #include <unistd.h>
+#include <cstdint>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -135,6 +137,9 @@ namespace xcs_utility {
 	string remove_comment(string const& source, string comment = "//");
 
 	vector<string> split(std::string s, std::string delimiter);
+
+	//! bytes allocated on the heap by a string, zero when its characters are stored in the string object
+	unsigned long heap_size(const string& str);
 };
 
 /**
@@ -213,4 +218,37 @@ class timer {
 	 unsigned long initial() const { return ti; };
 	 unsigned long final() const { return tf; };
 };
+
+//! timer class to measure elapsed wall-clock time on the monotonic clock, in nanoseconds
+/*!
+ * unlike timer, which reads the user CPU time with the resolution of the clock ticks, it includes
+ * the time spent in the system, waiting for I/O, and waiting for other threads
+ */
+class wall_timer {
+ private:
+	 uint64_t ti;	//! init time
+	 uint64_t tf;	//! stop time
+
+ public:
+	 wall_timer() { ti = tf = now(); };
+
+	 //! current reading of the monotonic clock in nanoseconds
+	 static uint64_t now()
+	 {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	 }
+
+	 void start() { ti = now(); };
+
+	 void stop() { tf = now(); };
+
+	 //! nanoseconds elapsed from start to stop
+	 uint64_t elapsed_ns() const { return tf - ti; };
+
+	 //! seconds elapsed from start to stop
+	 double elapsed() const { return double(tf - ti)*1e-9; };
+
+	 //! seconds elapsed from start to now
+	 double time() const { return double(now() - ti)*1e-9; };
+};
 #endif
@@ -0,0 +1,108 @@
+/*!
+ * \file frozen_population.h
+ *
+ * \brief compiles a static population into a decision structure that is queried without scanning [P]
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "xcs_definitions.h"
+
+using namespace std;
+
+#ifndef __FROZEN_POPULATION__
+#define __FROZEN_POPULATION__
+
+/*!
+ * \class frozen_population frozen_population.h
+ * \brief a population compiled into a decision diagram or into a dense table
+ *
+ * The classifiers are compiled into a reduced multi-terminal decision diagram: each node tests
+ * one input, each leaf contains the prediction array computed from the classifiers that match
+ * all the inputs on the path. Nodes with the same input and children are shared, and the inputs
+ * that no classifier still on the path specifies are skipped, thus a query visits at most one
+ * node for each input whatever the size of the population.
+ *
+ * When the inputs are at most max_table_bits, the diagram is also expanded into a dense table
+ * that maps every input configuration to its leaf, thus a query only packs the inputs into an index.
+ *
+ * The structure does not depend on [P] once built, thus it can be queried concurrently by several
+ * threads; it must be built again when [P] changes. The diagram can grow exponentially with the
+ * number of inputs, thus the build gives up when it exceeds max_nodes or max_bytes, and [P] must
+ * then be scanned instead. \sa xcs_classifier_system::freeze
+ */
+class frozen_population
+{
+public:
+	//! name of the class that implements the frozen population
+	string class_name() const { return string("frozen_population"); };
+
+	//! maximum number of inputs for which the dense table is built
+	static const unsigned long max_table_bits = 24;
+
+	//! maximum number of nodes of the decision diagram
+	static const unsigned long max_nodes = 1UL << 26;
+
+	//! maximum number of bytes taken by the diagram, the leaves, and the tables used to build them
+	static const unsigned long max_bytes = 1UL << 30;
+
+	//! class constructor for an empty structure
+	frozen_population() { no_inputs = 0; no_actions = 0; root = 0; };
+
+	/*!
+	 * \brief compiles a set of classifiers
+	 * \param conditions condition of each classifier as a string of 0, 1, and #
+	 * \param actions action of each classifier
+	 * \param predictions prediction of each classifier
+	 * \param fitness fitness of each classifier, used to weight the predictions as in the prediction array
+	 * \param no_actions number of actions
+	 * \param flag_table if true, the dense table is built when the inputs are at most max_table_bits
+	 * \return false if the set is empty or the diagram exceeds max_nodes or max_bytes; the structure is then empty and must not be queried
+	 */
+	bool build(const vector<string>& conditions, const vector<unsigned long>& actions, const vector<double>& predictions, const vector<double>& fitness, const unsigned long no_actions, const bool flag_table=true);
+
+	//! returns the prediction array for a batch of inputs \sa xcs_classifier_system::predict(const vector<t_state>&, vector<double>&, vector<bool>&) const
+	void predict(const vector<t_state>& inputs, vector<double>& prediction, vector<bool>& matched) const;
+
+	//! returns the leaf reached by an input configuration
+	unsigned long leaf(const string& input) const;
+
+	//! number of actions
+	unsigned long actions() const { return no_actions; };
+
+	//! number of nodes of the decision diagram
+	unsigned long nodes() const { return diagram.size(); };
+
+	//! number of leaves, i.e., of different prediction arrays
+	unsigned long leaves() const { return leaf_matched.size()/max(no_actions, 1UL); };
+
+	//! true if the dense table is used
+	bool table() const { return !dense_table.empty(); };
+
+	//! prints a summary of the structure
+	void print(ostream& output) const;
+
+private:
+	friend class frozen_population_builder;
+
+	//! a node of the decision diagram
+	struct t_node {
+		unsigned long	input;		//!< input tested by the node
+		uint32_t		child[2];	//!< next node when the input is 0 or 1
+	};
+
+	//! children that have this flag set are leaves
+	static const uint32_t leaf_flag = 0x80000000U;
+
+	unsigned long		no_inputs;		//!< number of inputs
+	unsigned long		no_actions;		//!< number of actions
+	uint32_t			root;			//!< root of the diagram, possibly a leaf
+
+	vector<t_node>		diagram;		//!< nodes of the diagram
+	vector<double>		leaf_payoff;	//!< prediction array of each leaf, leaf*no_actions+action
+	vector<bool>		leaf_matched;	//!< true if the action is advocated by some classifier in the leaf
+	vector<uint32_t>	dense_table;	//!< leaf of each input configuration, empty if not used
+};
+#endif
@@ -0,0 +1,103 @@
+/*!
+ * \file population_snapshot.h
+ *
+ * \brief read-only copy of a population used to evaluate it while [P] keeps changing
+ *
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "xcs_definitions.h"
+
+using namespace std;
+
+#ifndef __POPULATION_SNAPSHOT__
+#define __POPULATION_SNAPSHOT__
+
+/*!
+ * \class population_snapshot population_snapshot.h
+ * \brief a copy of the conditions, actions, predictions, and fitness of the classifiers in [P]
+ *
+ * The snapshot answers the same queries as xcs_classifier_system::predict by scanning its copy,
+ * thus it can be evaluated by other threads (e.g., to export the action-value function or to
+ * solve test problems) while the classifier system keeps learning. Unlike frozen_population,
+ * it is cheap to take whatever the number of inputs. \sa xcs_classifier_system::snapshot
+ */
+class population_snapshot
+{
+public:
+	//! name of the class that implements the snapshot
+	string class_name() const { return string("population_snapshot"); };
+
+	//! class constructor for an empty snapshot
+	population_snapshot() { no_actions = 0; };
+
+	//! stores a set of classifiers, as in frozen_population::build
+	void build(const vector<string>& conditions, const vector<unsigned long>& actions, const vector<double>& predictions, const vector<double>& fitness, const unsigned long no_actions);
+
+	//! returns the prediction array for a batch of inputs \sa xcs_classifier_system::predict(const vector<t_state>&, vector<double>&, vector<bool>&) const
+	void predict(const vector<t_state>& inputs, vector<double>& prediction, vector<bool>& matched) const;
+
+	//! computes the prediction arrays of a batch of inputs from any set of classifiers
+	/*!
+	 * \param scan called as scan(input, add) for each input, it must call add(action, prediction, fitness) for each classifier that matches input
+	 *
+	 * the prediction of each action is the fitness weighted average of the predictions of the
+	 * classifiers that match, as in xcs_classifier_system::build_prediction_array, and an action is
+	 * available when at least one of them advocates it; the kernel is shared by the snapshot and by
+	 * xcs_classifier_system, thus the two give the same predictions, and its buffers are owned by the
+	 * calling thread
+	 */
+	template <class t_scan>
+	static void predict_batch(const vector<t_state>& inputs, const unsigned long no_actions, const t_scan& scan, vector<double>& prediction, vector<bool>& matched)
+	{
+		static thread_local vector<double>			fitness_sum;
+		static thread_local vector<unsigned long>	no_matching;
+
+		if (prediction.size()!=inputs.size()*no_actions)
+			prediction.resize(inputs.size()*no_actions);
+		if (matched.size()!=inputs.size()*no_actions)
+			matched.resize(inputs.size()*no_actions);
+		if (fitness_sum.size()!=no_actions)
+			fitness_sum.resize(no_actions);
+		if (no_matching.size()!=no_actions)
+			no_matching.resize(no_actions);
+
+		for(unsigned long i=0; i<inputs.size(); i++)
+		{
+			double	*payoff = &prediction[i*no_actions];
+
+			fill(payoff, payoff+no_actions, 0.0);
+			fill(fitness_sum.begin(), fitness_sum.end(), 0.0);
+			fill(no_matching.begin(), no_matching.end(), 0);
+
+			scan(inputs[i].string_reference(), [&](const unsigned long act, const double pred, const double fit) {
+				payoff[act] += pred * fit;
+				fitness_sum[act] += fit;
+				no_matching[act]++;
+			});
+
+			for(unsigned long act=0; act<no_actions; act++)
+			{
+				matched[i*no_actions+act] = (no_matching[act]>0);
+				if (fitness_sum[act]>0)
+					payoff[act] /= fitness_sum[act];
+			}
+		}
+	};
+
+	//! number of actions
+	unsigned long actions() const { return no_actions; };
+
+	//! number of classifiers
+	unsigned long size() const { return conditions.size(); };
+
+private:
+	unsigned long			no_actions;		//!< number of actions
+	vector<t_condition>		conditions;		//!< conditions
+	vector<unsigned long>	actions_taken;	//!< actions
+	vector<double>			predictions;	//!< predictions
+	vector<double>			fitness;		//!< fitness
+};
+#endif
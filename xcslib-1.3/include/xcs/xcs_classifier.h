@@ -59,6 +59,9 @@ class xcs_classifier
 	//! restore the state of the classifier class from an input stream
 	static void	restore_state(istream& input) {input >> id_count;};
 
+	//! bytes taken by the classifier, including the heap blocks of its condition and action
+	unsigned long	footprint() const { return sizeof(xcs_classifier)+condition.allocated_size()+action.allocated_size(); };
+
 	//! generate a random classifier
 	void	random();			
 
@@ -9,7 +9,13 @@
 #include "xcs_definitions.h"
 #include "xcs_random.h"
 #include "xcs_statistics.h"
+#include "xcs_profiler.h"
+#include "xcs_event_trace.h"
+#include "xcs_memory_usage.h"
 #include "xcs_configuration_manager.h"
+#include "vector_env.h"
+#include "frozen_population.h"
+#include "population_snapshot.h"
 
 using namespace std;
 
@@ -126,12 +132,30 @@ void begin_problem();
 //! defines what must be done when the current problem ends
 void end_problem();
 
+//! defines what has to be done when a batch of problems solved in lockstep begins \sa step(vector_env&, const vector<bool>&, const vector<bool>&, const bool)
+void begin_batch(const unsigned long size);
+
+//! defines what must be done when the current batch of problems ends
+void end_batch();
+
 //! return the size of memory that is used during learning, i.e., the number of macro classifiers in [P]
 unsigned long size() const { return population.size(); };
 
+//! return the number of micro classifiers in [P]
+unsigned long micro_size() const { return population_size; };
+
 //! return the current system error
 double get_system_error() const { return system_error; };
 
+//! return the value of the action performed in the last step
+unsigned long performed_action() const { return last_action; };
+
+//! return the random numbers drawn by the environment while performing the action of the last step \sa xcs_random::draws
+unsigned long long performed_draws() const { return last_perform_draws; };
+
+//! return the current system error of episode i in the current batch
+double get_system_error(const unsigned long i) const { return batch_system_error[i]; };
+
 //! writes trace information on an output stream;
 /*!
  * it is called by the experiment manager just before the end_problem method
@@ -140,8 +164,14 @@ double get_system_error() const { return system_error; };
  */
 void trace(ostream &output) const {};
 
-//!	return the statistics of the current experiment
-xcs_statistics statistics() const { return stats; };
+//!	return the statistics of the current experiment, with the averages over [P] computed from the sums kept up to date during learning
+xcs_statistics statistics() const;
+
+//!	return the time spent in each phase of the steps of the current experiment, empty unless compiled with __PROFILE__
+const xcs_profiler& profile() const { return profiler; };
+
+//!	return the memory taken by the classifiers and the sets in the current experiment
+xcs_memory_usage memory_usage() const;
 
 //!	restore XCS state from an input stream
 void restore_state(istream &input);
@@ -152,6 +182,9 @@ void save_state(ostream &output);
 //!	save population
 void save_population(ostream &ouput);
 
+//!	hash of [P] as it is saved by save_population, to check that two runs end with the same population
+uint64_t fingerprint() const;
+
 //@}
 
 public:
@@ -184,6 +217,9 @@ typedef vector<t_classifier *>::const_iterator t_set_const_iterator;
 bool update_during_test_problems() const { return flag_update_test; }
 	
 private:
+	//! times the private kernels on synthetic populations (see src/tools/xcs_bench.cpp)
+	friend class xcs_benchmark;
+
 	//================================================================================
 	//
 	//
@@ -202,6 +238,8 @@ private:
 	unsigned long		problem_steps;			//! total number of steps within the single problem
 	double				total_reward;			//! total reward gained during the problem
 	double				system_error;			//! difference between predicted payoff and reward received (it is used only in single step problems)
+	unsigned long		last_action;			//! value of the action performed in the last step
+	unsigned long long	last_perform_draws;		//! random numbers drawn by the environment to perform the last action
 
 	//! [P] parameters
 	unsigned long		max_population_size;	//! maximum number of micro classifiers
@@ -287,6 +325,29 @@ private:
 						
 	xcs_statistics stats;					//! classifier system statistics
 
+	//! sums over [P] from which the averages of the statistics are computed; all but fitness are weighted by numerosity
+	struct t_population_sums {
+		double	prediction;
+		double	fitness;
+		double	error;
+		double	actionset_size;
+		double	experience;
+		double	time_stamp;
+	} population_sums;
+
+	//! add (sign=1) or remove (sign=-1) the contribution of a classifier to the sums over [P]; it is called before and after a classifier in [P] is changed
+	void	account(const t_classifier& classifier, const double sign);
+
+	//! compute the sums over [P] from scratch, after [P] has been initialized or restored
+	void	init_population_sums();
+
+	//! increase by one the numerosity of a classifier in [P], and the size of [P] accordingly
+	void	increment_numerosity(t_classifier& classifier);
+
+	xcs_profiler profiler;					//! time spent in the phases of the steps
+
+	xcs_memory_usage memory;				//! bytes of the classifiers allocated, and sizes of [P], [M], and [A]
+
 	const static std::vector<std::string> configuration_parameters;
 
 #ifdef __NICHE_TRACKING__	
@@ -345,6 +406,19 @@ private:
 
 	double		previous_reward;						//! reward received at previous time step
 
+	//! per episode variables used when a batch of problems is solved in lockstep; the episode being stepped is swapped in [M], [A]-1, and r-1
+	//@{
+	vector<t_state>					batch_inputs;			//! current input of each episode
+	vector<string>					batch_strings;			//! current input of each episode as a string
+	vector<t_classifier_set>			batch_match_sets;		//! [M] of each episode
+	vector<t_classifier_set>			batch_previous_action_sets;	//! [A]-1 of each episode
+	vector<double>					batch_previous_reward;		//! r-1 of each episode
+	vector<double>					batch_system_error;		//! system error of each episode
+	//@}
+
+	//! remove a classifier that is going to be deleted from the sets of the episodes in the batch
+	void	forget_classifier(t_classifier *classifier);
+
 
 	//! methods for setting the parameters from the configuration file
 	//@{
@@ -434,7 +508,25 @@ private:
 	//!  build the match set [M]; it returns the number of microclassifiers that match the sensory configuration
 	unsigned long	match(const t_state& detectors);
 
+	//! a step of every running episode in a batch of problems solved in lockstep
+	/*!
+	 * the inputs of all the running episodes are matched against [P] in one pass,
+	 * then the episodes are stepped one after the other; covering, reinforcement, and the GA
+	 * work as in the single step, thus the classifiers created by one episode are seen
+	 * by the other episodes from the next step
+	 * \param environments one environment for each episode
+	 * \param running true for the episodes that must be stepped
+	 * \param exploration true for the episodes solved in exploration
+	 */
+	void	step(vector_env& environments, const vector<bool>& running, const vector<bool>& exploration, const bool condensationMode);
+
+	//! build the match sets of a batch of inputs with one pass over [P]; inputs that are not running get an empty match set
+	void	match(const vector<t_state>& detectors, const vector<bool>& running, vector<t_classifier_set>& match_sets);
+
  private:
+	//! the part of a step that follows the matching: covering, action selection, reinforcement, and GA
+	void	step_matched(const bool exploration_mode, const bool condensationMode);
+
 	//! true if the problem is solved in exploration (Wilson 1995), i.e., XCS is in learning (Butz 2001)
 	bool		exploration_mode;	
  public:
@@ -547,6 +639,37 @@ private:
 	//! returns the average gradient in a set
 	double	average_gradient(const t_classifier_set &set) const;
 
+	//! returns the prediction array for the inputs; it performs covering, thus it can modify [P]
 	std::vector<double> predict(t_state inputs);
+
+ private:
+	//! returns the condition, action, prediction, and fitness of each classifier in [P]
+	void population_arrays(vector<string>& conditions, vector<unsigned long>& actions, vector<double>& predictions, vector<double>& fitness) const;
+
+ public:
+
+	//! returns the prediction array for a batch of inputs without modifying [P]
+	/*!
+	 * \param inputs the N input configurations
+	 * \param prediction the N x |A| predictions, row by row, i.e., the payoff of action a in inputs[i] is prediction[i*|A|+a]
+	 * \param matched the N x |A| flags, false when no classifier in [P] matches inputs[i] and advocates action a (the prediction is zero)
+	 *
+	 * No covering is performed and no member is modified; the two outputs are resized only if
+	 * they have the wrong size, thus no memory is allocated when they are reused. The function can
+	 * be called concurrently by several threads as long as [P] does not change.
+	 */
+	void predict(const vector<t_state>& inputs, vector<double>& prediction, vector<bool>& matched) const;
+
+	//! number of actions, i.e., the size of the prediction array
+	unsigned long actions() const { return prediction_array.size(); };
+
+	//! compiles the current [P] into a structure that is queried without scanning [P]; it returns false if [P] is empty or too large to be compiled \sa frozen_population
+	bool freeze(frozen_population& frozen, const bool flag_table=true) const;
+
+	//! copies the current [P] into a read-only snapshot that other threads can evaluate while [P] changes
+	void snapshot(population_snapshot& copy) const;
+
+	//! returns the number of (input, action) pairs where the frozen population and [P] predict different payoffs or matches
+	unsigned long compare(const frozen_population& frozen, const vector<t_state>& inputs, const double tolerance=1e-9) const;
 };
 #endif
@@ -147,13 +147,16 @@ ternary_condition::operator=(const ternary_condition& cond)
 //
 bool
 ternary_condition::match(const binary_inputs& sens) const
+{
+	return match(sens.string_reference());
+}
+
+bool
+ternary_condition::match(const string& input) const
 {
 	string::size_type	bit;
-	string			input;
 	bool			result;
 
-	input = sens.string_value();
-
 	assert(input.size()==bitstring.size());
 
 	bit = 0;
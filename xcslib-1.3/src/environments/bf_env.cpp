@@ -82,6 +82,22 @@ bf_env::set_parameters(xcs_configuration_manager& xcs_config)
 			set_parameters_eq(xcs_config);
 			break;
 
+		case HIDDEN_PARITY_FUNCTION:
+			set_parameters_hidden_parity(xcs_config);
+			break;
+
+		case COUNT_ONES_FUNCTION:
+			set_parameters_count_ones(xcs_config);
+			break;
+
+		case CARRY_FUNCTION:
+			set_parameters_carry(xcs_config);
+			break;
+
+		case HIERARCHICAL_MULTIPLEXER_FUNCTION:
+			set_parameters_hierarchical_mp(xcs_config);
+			break;
+
 		default:
 			xcs_utility::error(class_name(), "set_parameters","binary function not supported",1);
 	}
@@ -89,6 +105,16 @@ bf_env::set_parameters(xcs_configuration_manager& xcs_config)
 	no_configurations = 1;
 	no_configurations <<= state_size;
 
+	no_words = (state_size+63)/64;
+	packed_inputs.assign(no_words, 0ULL);
+
+	//! pack the selected variables into a mask over the inputs
+	relevant_mask.assign(no_words, 0ULL);
+	for(vector<unsigned long>::const_iterator in=selected_inputs.begin(); in!=selected_inputs.end(); in++)
+	{
+		unsigned long bit = state_size-1-(*in);
+		relevant_mask[bit>>6] |= (1ULL<<(bit&63));
+	}
 }
 
 void
@@ -135,6 +161,120 @@ bf_env::set_parameters_majority_on(xcs_configuration_manager& xcs_config)
 	threshold = state_size/2;
 }
 
+void
+bf_env::set_relevant_inputs(xcs_configuration_manager& xcs_config)
+{
+	try {
+		state_size = (unsigned long) xcs_config.Value(tag_name(), "input size");
+	} catch (...) {
+		xcs_utility::error(class_name(), "constructor", "attribute \'input size\' not found in <" + tag_name() + ">", 1);
+	}
+
+	try {
+		no_relevant_bits = (unsigned long) xcs_config.Value(tag_name(), "number of relevant bits");
+	} catch (...) {
+		xcs_utility::error(class_name(), "constructor", "attribute \'number of relevant bits\' not found in <" + tag_name() + ">", 1);
+	}
+
+	//! by default the relevant bits are the first ones in the input string
+	read_selected_variables((string) xcs_config.Value(tag_name(), "relevant inputs", ""), selected_inputs);
+
+	if (selected_inputs.empty())
+	{
+		for(unsigned long in=0; in<no_relevant_bits; in++)
+			selected_inputs.push_back(in);
+	}
+
+	if ((selected_inputs.size()!=no_relevant_bits) || (no_relevant_bits==0) || (no_relevant_bits>state_size))
+	{
+		xcs_utility::error(class_name(), "constructor", "wrong number of relevant inputs in <" + tag_name() + ">", 1);
+	}
+}
+
+void
+bf_env::read_selected_variables(const string& str_inputs, vector<unsigned long>& inputs) const
+{
+	istringstream	INPUTS(str_inputs);
+	unsigned long	in;
+
+	inputs.clear();
+
+	while (INPUTS >> in)
+	{
+		if (in>=state_size)
+		{
+			xcs_utility::error(class_name(), "read_selected_variables", "relevant input out of range", 1);
+		}
+		inputs.push_back(in);
+	}
+}
+
+void
+bf_env::set_parameters_hidden_parity(xcs_configuration_manager& xcs_config)
+{
+	set_relevant_inputs(xcs_config);
+}
+
+void
+bf_env::set_parameters_count_ones(xcs_configuration_manager& xcs_config)
+{
+	set_relevant_inputs(xcs_config);
+
+	threshold = no_relevant_bits/2;
+}
+
+void
+bf_env::set_parameters_carry(xcs_configuration_manager& xcs_config)
+{
+	try {
+		state_size = (unsigned long) xcs_config.Value(tag_name(), "input size");
+	} catch (...) {
+		xcs_utility::error(class_name(), "constructor", "attribute \'input size\' not found in <" + tag_name() + ">", 1);
+	}
+
+	if ((state_size%2!=0) || (state_size>126))
+	{
+		xcs_utility::error(class_name(), "constructor", "carry function needs an even input size up to 126 bits", 1);
+	}
+
+	addend_size = state_size/2;
+}
+
+void
+bf_env::set_parameters_hierarchical_mp(xcs_configuration_manager& xcs_config)
+{
+	try {
+		address_size = (unsigned long) xcs_config.Value(tag_name(), "address size");
+	} catch (...) {
+		xcs_utility::error(class_name(), "constructor", "attribute \'address size\' not found in <" + tag_name() + ">", 1);
+	}
+
+	string str_block = (string) xcs_config.Value(tag_name(), "block function", "multiplexer");
+
+	if (str_block=="multiplexer")
+	{
+		flag_parity_blocks = false;
+	} else if (str_block=="parity") {
+		flag_parity_blocks = true;
+	} else {
+		xcs_utility::error(class_name(), "constructor", "block function \'" + str_block + "\' not supported", 1);
+	}
+
+	no_blocks = address_size + (1UL<<address_size);
+	state_size = 3*no_blocks;
+
+	if (state_size>64)
+	{
+		xcs_utility::error(class_name(), "constructor", "hierarchical multiplexer supports up to 64 inputs", 1);
+	}
+
+	block_mask = 0;
+	for(unsigned long block=0; block<no_blocks; block++)
+	{
+		block_mask |= (1ULL<<(3*block));
+	}
+}
+
 bf_env::t_binary_function 
 bf_env::get_binary_function(string str_function)
 {
@@ -148,6 +288,13 @@ bf_env::get_binary_function(string str_function)
 		return EQUALITY_FUNCTION;
 	if (str_function=="majority")
 		return MAJORITY_ON_FUNCTION;
+	if (str_function=="carry")
+		return CARRY_FUNCTION;
+	if (str_function=="hierarchical-multiplexer")
+		return HIERARCHICAL_MULTIPLEXER_FUNCTION;
+
+	xcs_utility::error(class_name(), "get_binary_function", "binary function \'" + str_function + "\' not supported", 1);
+	return MULTIPLEXER_FUNCTION;
 }
 
 string
@@ -173,9 +320,13 @@ bf_env::print_binary_function(t_binary_function binary_function)
 		case CARRY_FUNCTION:
 			return "carry";
 
+		case HIERARCHICAL_MULTIPLEXER_FUNCTION:
+			return "hierarchical-multiplexer";
+
 		default:
 			xcs_utility::error(class_name(), "set_parameters","binary function not supported",1);
 	}
+	return "";
 }
 
 /*!
@@ -191,20 +342,70 @@ bf_env::print_binary_function(t_binary_function binary_function)
 void	
 bf_env::begin_problem(const bool explore)
 {
-	string	str = "";
+	//! one random draw for every 64 inputs
+	for(unsigned long word=0; word<no_words; word++)
+	{
+		packed_inputs[word] = xcs_random::bits();
+	}
 
-	for(string::size_type bit = 0; bit<state_size; bit++)
+	//! clear the unused bits of the most significant word
+	if (state_size & 63)
 	{
-		str += '0' + xcs_random::dice(2);
+		packed_inputs[no_words-1] &= (~0ULL >> (64 - (state_size & 63)));
 	}
 
-	inputs.set_string_value(str);
+	update_inputs();
 
 	current_reward = 0;
 
 	first_problem = false;
 }
 
+void
+bf_env::update_inputs()
+{
+	string	str(state_size, '0');
+
+	for(unsigned long pos=0; pos<state_size; pos++)
+	{
+		if (input_bit(pos))
+			str[pos] = '1';
+	}
+
+	inputs.set_string_value(str);
+}
+
+void
+bf_env::set_packed_inputs(unsigned long configuration)
+{
+	fill(packed_inputs.begin(), packed_inputs.end(), 0ULL);
+	packed_inputs[0] = configuration;
+	update_inputs();
+}
+
+unsigned long long
+bf_env::input_field(unsigned long pos, unsigned long len) const
+{
+	assert((len>0) && (len<=64) && (pos+len<=state_size));
+
+	unsigned long		low = state_size-pos-len;
+	unsigned long		word = low>>6;
+	unsigned long		shift = low&63;
+	unsigned long long	value = packed_inputs[word]>>shift;
+
+	if (shift && (word+1<no_words))
+	{
+		value |= packed_inputs[word+1]<<(64-shift);
+	}
+
+	if (len<64)
+	{
+		value &= (1ULL<<len)-1;
+	}
+
+	return value;
+}
+
 bool	
 bf_env::stop()
 const
@@ -231,15 +432,33 @@ bf_env::perform(const t_action& action)
 			perform_majority_on(action);
 			break;
 
+		case HIDDEN_PARITY_FUNCTION:
+			perform_hidden_parity(action);
+			break;
+
+		case COUNT_ONES_FUNCTION:
+			perform_count_ones(action);
+			break;
+
 		case CARRY_FUNCTION:
 			perform_carry(action);
 			break;
 
+		case HIERARCHICAL_MULTIPLEXER_FUNCTION:
+			perform_hierarchical_mp(action);
+			break;
+
 		default:
 			xcs_utility::error(class_name(),"perform","function not supported",1);
 	}
 }
 
+void
+bf_env::set_reward(unsigned long result, const t_action& action)
+{
+	current_reward = (result==action.value())?1000:0;
+}
+
 //! only the current reward is traced
 void
 bf_env::trace(ostream& output) const
@@ -247,27 +466,36 @@ bf_env::trace(ostream& output) const
 	output << current_reward;
 }
 
+void
+bf_env::reset_problem()
+{
+	if (state_size>max_test_size)
+	{
+		xcs_utility::error(class_name(), "reset_problem", "the 2^" + to_string(state_size) + " input configurations cannot be enumerated to test the environment or to save the action-value function, at most " + to_string(max_test_size) + " inputs are allowed", 1);
+	}
+	reset_input();
+}
+
 void 
 bf_env::reset_input()
 {
 	current_state = 0;
-	inputs.set_string_value(xcs_utility::long2binary(current_state,state_size));
+	set_packed_inputs(current_state);
 }
 
 bool 
 bf_env::next_input()
 {
-	string	binary;
 	bool	valid = false;
 
 	current_state++; 
 	if (current_state<no_configurations)
 	{
-		inputs.set_string_value(xcs_utility::long2binary(current_state,state_size));
+		set_packed_inputs(current_state);
 		valid = true;
 	} else {
 		current_state = 0;
-		inputs.set_string_value(xcs_utility::long2binary(current_state,state_size));
+		set_packed_inputs(current_state);
 		valid = false;
 	}
 	return valid;
@@ -300,63 +528,21 @@ bf_env::bf_env()
 void	
 bf_env::perform_eq(const t_action& action)
 {
-	string				str_inputs;
-	unsigned long		in;
-	unsigned long		sum;
 	unsigned long		result;
 	
-	str_inputs = inputs.string_value();
-
-	sum = 0;
-
-	for(in=0; in<inputs.size(); in++)
-	{
-		sum += str_inputs[in]-'0';
-	}
+	result = (count_ones()==no_ones)?1:0;
 
-	if (sum==no_ones)
-		result = 1;
-	else 
-		result = 0;
-
-	if (result==action.value())
-	{
-		current_reward = 1000;
-	} else {
-		current_reward = 0;
-	}
+	set_reward(result, action);
 }
 
 void	
 bf_env::perform_majority_on(const t_action& action)
 {
-	string				str_inputs;
-	unsigned long		in;
-	unsigned long		sum;
 	unsigned long		result;
 	
-	str_inputs = inputs.string_value();
-
-	sum = 0;
+	result = (count_ones()>threshold)?1:0;
 
-	for(in=0; in<inputs.size(); in++)
-	{
-		sum += str_inputs[in]-'0';
-	}
-
-	if (sum>int(str_inputs.size()/2))
-	{
-		result = 1;
-	} else {
-		result = 0;
-	}
-
-	if (result==action.value())
-	{
-		current_reward = 1000;
-	} else {
-		current_reward = 0;
-	}
+	set_reward(result, action);
 }
 
 void	
@@ -367,67 +553,98 @@ bf_env::perform_mp(const t_action& action)
 	cout << "PERFORM_MP MULTIPLEXER PARAMETERS" << endl;
 	#endif
 
-	string str_inputs = inputs.string_value();
-
-	unsigned long		address;
 	unsigned long		index;		
+	unsigned long		value;		
 
-	index = xcs_utility::binary2long(str_inputs.substr(0,address_size));
-	address = address_size + index;
+	index = input_field(0,address_size);
+	value = input_bit(address_size + index);
 
 	if (!flag_layered_reward)
 	{
-		if ((str_inputs[address]-'0')==action.value())
+		if (value==action.value())
 		{
 			current_reward = 1000;
 		} else {
 			current_reward = 0;
 		}
 	} else {
-		if ((str_inputs[address]-'0')==action.value())
+		if (value==action.value())
 		{
-			current_reward = 300 + index*200 + double(100*(unsigned long)(str_inputs[address]-'0'));
+			current_reward = 300 + index*200 + double(100*value);
 		} else {
-			current_reward = index*200 + double(100*(unsigned long)(str_inputs[address]-'0'));
+			current_reward = index*200 + double(100*value);
 		}
 	}
 #ifdef __DEBUG_ENVIRONMENT__
-	cout << "INPUT " << inputs << " BIT " << str_inputs[address] << " ACTION " << action.value() << " REWARD " << current_reward << endl;
+	cout << "INPUT " << inputs << " BIT " << value << " ACTION " << action.value() << " REWARD " << current_reward << endl;
 #endif
 }
 
+//! the output is the carry of the sum of the two addends, i.e., the first and the second half of the inputs
 void	
 bf_env::perform_carry(const t_action& action)
 {
-	string				str_inputs;
-	unsigned long		in;
-	unsigned long		sum;
-	unsigned long		result;
-	
-	str_inputs = inputs.string_value();
+	unsigned long long	first = input_field(0, addend_size);
+	unsigned long long	second = input_field(addend_size, addend_size);
+	unsigned long		carry;
 
-    unsigned int no_bits = str_inputs.size()/2;
+	if (addend_size<64)
+	{
+		carry = ((first+second)>>addend_size) & 1ULL;
+	} else {
+		carry = (first+second<first)?1:0;
+	}
 
-    std::string first = str_inputs.substr(0,no_bits);
-    std::string second = str_inputs.substr(no_bits,no_bits);
+	set_reward(carry, action);
+}
 
-    int carry = 0;
-    int digit = 0;
+//! the output is the parity of the relevant inputs
+void	
+bf_env::perform_hidden_parity(const t_action& action)
+{
+	set_reward(count_relevant_ones() & 1UL, action);
+}
 
-    for(int i=no_bits-1; i>=0; i--)
-    {
-        digit = (int(first[i]-'0')+int(second[i]-'0')+carry)%2;
-        int updated_carry = (int(first[i]-'0')+int(second[i]-'0')+carry)/2;
-        std::cout << first[i] << "+" << second[i] << "+" << carry << " = " << digit << " carry " << updated_carry << std::endl;
-        carry = updated_carry;
-    }
+//! the output is one if more than half of the relevant inputs are set to one
+void	
+bf_env::perform_count_ones(const t_action& action)
+{
+	set_reward((count_relevant_ones()>threshold)?1:0, action);
+}
 
-	if (carry==action.value())
+/*!
+ * the inputs are split in blocks of three bits; each block is evaluated either as a 3 bit 
+ * multiplexer or as a 3 bit parity and the block outputs are the inputs of a multiplexer
+ * with the specified address size (Butz et al. 2006). All the blocks are evaluated at once 
+ * on the packed inputs.
+ */
+void	
+bf_env::perform_hierarchical_mp(const t_action& action)
+{
+	uint64_t	in = packed_inputs[0];
+	uint64_t	first = (in>>2) & block_mask;
+	uint64_t	second = (in>>1) & block_mask;
+	uint64_t	third = in & block_mask;
+	uint64_t	blocks;
+	uint64_t	top = 0;
+
+	if (flag_parity_blocks)
 	{
-		current_reward = 1000;
+		blocks = first ^ second ^ third;
 	} else {
-		current_reward = 0;
+		//! the first bit of the block addresses one of the other two
+		blocks = (first & third) | (~first & second & block_mask);
 	}
-}
 
+	//! gather the block outputs; the first block is the most significant bit
+	for(unsigned long block=0; block<no_blocks; block++)
+	{
+		top |= ((blocks>>(3*block)) & 1ULL)<<block;
+	}
 
+	unsigned long data_size = no_blocks - address_size;
+	unsigned long index = top>>data_size;
+	unsigned long value = (top>>(data_size-1-index)) & 1ULL;
+
+	set_reward(value, action);
+}
@@ -0,0 +1,195 @@
+/*!
+ * \file replay_env.cpp
+ *
+ * \brief implements the environment that replays a recorded interaction stream
+ *
+ */
+
+#include <sstream>
+#include "xcs_utility.h"
+#include "xcs_random.h"
+
+#include "replay_env.h"
+
+using namespace std;
+
+bool					replay_env::init = false;
+xcs_interaction_stream	replay_env::stream;
+vector<t_state>			replay_env::states;
+string					replay_env::stream_filename;
+const std::vector<std::string> replay_env::configuration_parameters = {"stream file"};
+
+replay_env::replay_env(xcs_configuration_manager& xcs_config)
+{
+	if (!replay_env::init)
+	{
+		if (!xcs_config.exist(tag_name()))
+		{
+			xcs_utility::error(class_name(), "constructor", "section <" + tag_name() + "> not found", 1);
+		}
+
+		xcs_config.check_parameters(tag_name(), configuration_parameters);
+
+		try {
+			stream_filename = (string) xcs_config.Value(tag_name(), "stream file");
+		} catch (...) {
+			xcs_utility::error(class_name(), "constructor", "attribute \'stream file\' not found in <" + tag_name() + ">", 1);
+		}
+
+		stream.read(stream_filename);
+
+		//! the actions are compared by value, thus they must be the same of the recorded run
+		t_action	action;
+
+		if (action.actions()!=stream.no_actions)
+		{
+			xcs_utility::error(class_name(), "constructor", "'" + stream_filename + "' was recorded with " + to_string(stream.no_actions) + " actions, " + to_string(action.actions()) + " are available", 1);
+		}
+
+		if (stream.seed==0)
+		{
+			xcs_utility::warning(class_name(), "constructor", "the recorded run was seeded from the clock, the classifier system will not retrace it");
+		} else if (stream.seed!=xcs_random::get_seed()) {
+			xcs_utility::warning(class_name(), "constructor", "the recorded run used seed " + to_string(stream.seed) + ", the classifier system will not retrace it");
+		}
+
+		states.resize(stream.states.size());
+		for(unsigned long s=0; s<stream.states.size(); s++)
+			states[s].set_string_value(stream.states[s]);
+
+		clog << "<" << tag_name() << ">" << endl;
+		clog << "\t" << "stream file = " << stream_filename << endl;
+		clog << "\t" << "experiments = " << stream.experiments.size() << endl;
+		clog << "\t" << "problems = " << stream.problems.size() << endl;
+		clog << "\t" << "steps = " << stream.steps.size() << endl;
+		clog << "\t" << "states = " << stream.states.size() << endl;
+		clog << "</" << tag_name() << ">" << endl;
+	}
+	replay_env::init = true;
+
+	current_experiment = -1;
+	current_problem = 0;
+	next_problem_index = 0;
+	current_step = 0;
+	current_reward = 0;
+	current_stop = false;
+	no_steps = 0;
+	no_divergent_actions = 0;
+	no_divergent_modes = 0;
+}
+
+void
+replay_env::begin_experiment()
+{
+	current_experiment++;
+	if (current_experiment>=(long) stream.experiments.size())
+	{
+		xcs_utility::error(class_name(), "begin_experiment", "'" + stream_filename + "' contains " + to_string(stream.experiments.size()) + " experiments only", 1);
+	}
+
+	next_problem_index = 0;
+	no_steps = 0;
+	no_divergent_actions = 0;
+	no_divergent_modes = 0;
+}
+
+void
+replay_env::end_experiment()
+{
+	if (no_divergent_actions>0 || no_divergent_modes>0)
+	{
+		ostringstream	msg;
+
+		msg << "experiment " << stream.experiments[current_experiment].number << " of the log: ";
+		msg << no_divergent_actions << " of " << no_steps << " actions and ";
+		msg << no_divergent_modes << " of " << next_problem_index << " problem modes differ from the recorded ones";
+		xcs_utility::warning(class_name(), "end_experiment", msg.str());
+	}
+}
+
+//! the experiment manager may begin an experiment with begin_problem only, thus the first experiment of the log is selected
+void
+replay_env::begin_problem(const bool explore)
+{
+	if (current_experiment<0)
+		begin_experiment();
+
+	const xcs_interaction_stream::t_experiment	&experiment = stream.experiments[current_experiment];
+
+	if (next_problem_index>=(long) experiment.no_problems)
+	{
+		xcs_utility::error(class_name(), "begin_problem", "experiment " + to_string(experiment.number) + " of '" + stream_filename + "' contains " + to_string(experiment.no_problems) + " problems only", 1);
+	}
+
+	current_problem = experiment.first_problem+next_problem_index;
+	next_problem_index++;
+	current_step = 0;
+	current_reward = 0;
+	current_stop = false;
+
+	const xcs_interaction_stream::t_problem	&problem = stream.problems[current_problem];
+
+	if (problem.exploration!=explore)
+		no_divergent_modes++;
+
+	xcs_random::discard(problem.draws);
+}
+
+void
+replay_env::perform(const t_action& action)
+{
+	const xcs_interaction_stream::t_problem	&problem = stream.problems[current_problem];
+
+	if (current_step>=problem.no_steps)
+	{
+		xcs_utility::error(class_name(), "perform", "problem " + to_string(current_problem) + " of '" + stream_filename + "' ended after " + to_string(problem.no_steps) + " steps", 1);
+	}
+
+	const xcs_interaction_stream::t_step	&step = stream.steps[problem.first_step+current_step];
+
+	if (action.value()!=step.action)
+		no_divergent_actions++;
+
+	current_reward = step.reward;
+	current_stop = step.stop;
+	current_step++;
+	no_steps++;
+
+	xcs_random::discard(step.draws);
+}
+
+//! once the recorded steps are over, the last recorded state is returned
+t_state
+replay_env::state() const
+{
+	if (stream.steps.empty())
+		return t_state();
+
+	const xcs_interaction_stream::t_problem	&problem = stream.problems[current_problem];
+	unsigned long	step = problem.first_step+current_step;
+
+	if (current_step>=problem.no_steps)
+		step = (problem.no_steps>0) ? problem.first_step+problem.no_steps-1 : 0;
+
+	return states[stream.steps[step].state];
+}
+
+void
+replay_env::trace(ostream& output) const
+{
+	output << current_problem << '\t' << current_reward;
+}
+
+void
+replay_env::save_state(ostream& output) const
+{
+	output << endl;
+	output << current_experiment << '\t' << next_problem_index << endl;
+}
+
+void
+replay_env::restore_state(istream& input)
+{
+	input >> current_experiment;
+	input >> next_problem_index;
+}
@@ -0,0 +1,80 @@
+/*!
+ * \file vector_env.cpp
+ *
+ * \brief implements a batch of independent environments that are solved in lockstep
+ *
+ */
+
+#include "xcs_utility.h"
+#include "xcs_definitions.h"
+#include "vector_env.h"
+
+vector_env::vector_env(const t_environment& environment, unsigned long size)
+{
+	if (size==0)
+	{
+		xcs_utility::error(class_name(), "constructor", "the batch must contain at least one environment", 1);
+	}
+
+	environments.assign(size, environment);
+}
+
+void
+vector_env::begin_problem(const bool explore)
+{
+	for(vector<t_environment>::iterator env=environments.begin(); env!=environments.end(); env++)
+	{
+		env->begin_problem(explore);
+	}
+}
+
+void
+vector_env::end_problem()
+{
+	for(vector<t_environment>::iterator env=environments.begin(); env!=environments.end(); env++)
+	{
+		env->end_problem();
+	}
+}
+
+void
+vector_env::states(vector<t_state>& inputs) const
+{
+	inputs.resize(environments.size());
+	for(unsigned long i=0; i<environments.size(); i++)
+	{
+		inputs[i] = environments[i].state();
+	}
+}
+
+void
+vector_env::perform(const vector<t_action>& actions)
+{
+	assert(actions.size()==environments.size());
+
+	for(unsigned long i=0; i<environments.size(); i++)
+	{
+		environments[i].perform(actions[i]);
+	}
+}
+
+void
+vector_env::rewards(vector<double>& rewards) const
+{
+	rewards.resize(environments.size());
+	for(unsigned long i=0; i<environments.size(); i++)
+	{
+		rewards[i] = environments[i].reward();
+	}
+}
+
+bool
+vector_env::stop() const
+{
+	for(vector<t_environment>::const_iterator env=environments.begin(); env!=environments.end(); env++)
+	{
+		if (!env->stop())
+			return false;
+	}
+	return true;
+}
@@ -108,34 +108,82 @@ woods_env::read_map(string filename)
 		clog << endl;
 #endif
 
-		///
-		free_pos_x.clear();
-		free_pos_y.clear();
+		build_tables();
 	
-		t_state		free_position;
-		configurations.clear();
+		current_configuration = 0;
+		current_position = 0;
+}
+
+/*!
+ * The map is static, thus the sensory inputs, the rewards, and the effect of every move 
+ * are computed once for every position the agent can occupy. Positions are numbered 
+ * row by row: free positions first, then food positions, so that the first env_free_pos 
+ * positions are the possible starting points.
+ */
+void
+woods_env::build_tables()
+{
+	static int	inc_x[] = { 0, +1, +1, +1,  0, -1, -1, -1};
+	static int	inc_y[] = {-1, -1,  0, +1, +1, +1,  0, -1};
 
-		for (unsigned long y=0; y<env_rows; y++)
+	position_x.clear();
+	position_y.clear();
+
+	for (unsigned long y=0; y<env_rows; y++)
+	{
+		for (unsigned long x=0; x<env_columns; x++)
 		{
-			for (unsigned long x=0; x<env_columns; x++)
+			if (is_free(x,y))
 			{
-				if (is_free(x,y))
-				{
-					get_input(x,y,free_position);
-					configurations.push_back(free_position.string_value());
+				position_x.push_back(x);
+				position_y.push_back(y);
+			}
+		}
+	}
 
-					free_pos_x.push_back(x);
-					free_pos_y.push_back(y);
-				}
+	for (unsigned long y=0; y<env_rows; y++)
+	{
+		for (unsigned long x=0; x<env_columns; x++)
+		{
+			if (is_food(x,y))
+			{
+				position_x.push_back(x);
+				position_y.push_back(y);
 			}
 		}
-	
-	
-		current_pos_x = 0;
-		current_pos_y = 0;
-	
-		current_configuration = 0;
+	}
 
+	env_positions = position_x.size();
+
+	cell_position.assign(env_rows*env_columns, env_positions);
+	for (unsigned long pos=0; pos<env_positions; pos++)
+	{
+		cell_position[position_y[pos]*env_columns+position_x[pos]] = pos;
+	}
+
+	position_inputs.resize(env_positions);
+	position_reward.resize(env_positions);
+	next_position.resize(env_positions*no_moves);
+
+	t_state		sensors;
+
+	for (unsigned long pos=0; pos<env_positions; pos++)
+	{
+		get_input(position_x[pos], position_y[pos], sensors);
+		position_inputs[pos] = sensors.string_value();
+
+		position_reward[pos] = (pos<env_free_pos)?0:1000;
+
+		//! moves toward obstacles leave the agent in the same position
+		for (unsigned long act=0; act<no_moves; act++)
+		{
+			unsigned long next_x = cicle(position_x[pos]+inc_x[act], env_columns);
+			unsigned long next_y = cicle(position_y[pos]+inc_y[act], env_rows);
+			unsigned long next = cell_position[next_y*env_columns+next_x];
+
+			next_position[pos*no_moves+act] = (next<env_positions)?next:pos;
+		}
+	}
 }
 
 void 
@@ -174,28 +222,21 @@ woods_env::print_parameters(ostream& OUTPUT) const
 void	
 woods_env::begin_problem(const bool explore)
 {
-	ostringstream	PATH;
-   	unsigned long	where;
-
 	//! at the beginning of the problem the previous information about the agent's path is cleared
 	path = "";
 
 	//! random restart
-	where = (unsigned long) (env_free_pos*xcs_random::random());
-		
-	current_pos_x = free_pos_x[where];
-	current_pos_y = free_pos_y[where];
+	current_position = (unsigned long) (env_free_pos*xcs_random::random());
 	set_state();
 
-	PATH << "(" << current_pos_x << "," << current_pos_y << ")";
-	path += PATH.str();
+	path += "(" + to_string(current_pos_x) + "," + to_string(current_pos_y) + ")";
 }
 
 bool	
 woods_env::stop()
 const
 {
-	return(is_food(current_pos_x,current_pos_y)); 
+	return(current_position>=env_free_pos); 
 }
 
 
@@ -203,12 +244,9 @@ void
 woods_env::perform(const t_action& action)
 {
 	static int 	sliding[] = {-1,1};
-	static int	inc_x[] = { 0, +1, +1, +1,  0, -1, -1, -1};
-	static int	inc_y[] = {-1, -1,  0, +1, +1, +1,  0, -1};
 
 	unsigned long	act;
-	unsigned long	next_x;
-	unsigned long	next_y;
+	unsigned long	next;
 
 	act = action.value();
 
@@ -217,18 +255,15 @@ woods_env::perform(const t_action& action)
 		act = cicle(act + sliding[xcs_random::dice(2)], action.actions());
 	}
 
-	next_x=cicle(current_pos_x+inc_x[act], env_columns);
-	next_y=cicle(current_pos_y+inc_y[act], env_rows);
+	next = next_position[current_position*no_moves+act];
 
-	if ((is_free(next_x,next_y)) || (is_food(next_x,next_y)))
+	if (next!=current_position)
 	{
-		current_pos_x = next_x;
-		current_pos_y = next_y;
+		current_position = next;
 		set_state();
 	}
-	ostringstream PATH;
-	PATH << "(" << current_pos_x << "," << current_pos_y << ")";
-	path += PATH.str();
+
+	path += "(" + to_string(current_pos_x) + "," + to_string(current_pos_y) + ")";
 }
 
 void
@@ -263,6 +298,7 @@ woods_env::restore_state(istream& input)
 	input >> current_pos_x; 
 	input >> current_pos_y;
 	input >> current_configuration;
+	current_position = cell_position[current_pos_y*env_columns+current_pos_x];
 	set_state();
 }
 
@@ -353,14 +389,11 @@ inline
 void	
 woods_env::set_state()
 {
-	get_input(current_pos_x,current_pos_y,inputs);
+	current_pos_x = position_x[current_position];
+	current_pos_y = position_y[current_position];
 
-	if (is_food(current_pos_x,current_pos_y))
-	{
-		current_reward = 1000;
-	} else {
-		current_reward = 0;
-	}
+	inputs.set_string_value(position_inputs[current_position]);
+	current_reward = position_reward[current_position];
 }
 
 inline
@@ -423,16 +456,11 @@ const
 void
 woods_env::reset_problem()
 {
-	path = "";
-
 	current_configuration = 0;
-	current_pos_x = free_pos_x[current_configuration];
-	current_pos_y = free_pos_y[current_configuration];
+	current_position = current_configuration;
 	set_state();
 	
-	ostringstream PATH;
-	PATH << "(" << current_pos_x << "," << current_pos_y << ")";
-	path = PATH.str();
+	path = "(" + to_string(current_pos_x) + "," + to_string(current_pos_y) + ")";
 }
 
 
@@ -446,11 +474,8 @@ woods_env::next_problem()
 		return false;
 	}
 
-	current_pos_x = free_pos_x[current_configuration];
-	current_pos_y = free_pos_y[current_configuration];
+	current_position = current_configuration;
 	set_state();
-	ostringstream PATH;
-	PATH << "(" << current_pos_x << "," << current_pos_y << ")";
-	path = PATH.str();
+	path = "(" + to_string(current_pos_x) + "," + to_string(current_pos_y) + ")";
 	return true;
 }
@@ -1,6 +1,9 @@
 #include "xcs_utility.h"
 #include "experiment_mgr.h"
 #include "xcs_definitions.h"
+#include <atomic>
+#include <memory>
+#include <sys/resource.h>
 
 /*!
  * \file experiment_mgr.cpp
@@ -9,7 +12,7 @@
  *
  */
 
-const std::vector<std::string> experiment_mgr::configuration_parameters = {"first experiment","number of experiments","first problem","number of learning problems","number of condensation problems","number of test problems","maximum number of steps","save final population","save population every","save experiment final state","save experiment state every","save problem execution trace","teletransportation interval","test environment","save execution time report", "save action-value function"};
+const std::vector<std::string> experiment_mgr::configuration_parameters = {"first experiment","number of experiments","first problem","number of learning problems","number of condensation problems","number of test problems","maximum number of steps","save final population","save population every","save experiment final state","save experiment state every","save problem execution trace","teletransportation interval","test environment","parallel test environment","save execution time report", "save action-value function", "freeze population", "verify frozen population", "action-value function format", "number of threads", "concurrent test problems", "test snapshot interval", "batch size", "save population statistics", "save event trace", "event trace step interval", "live metrics", "record interaction stream"};
 
 experiment_mgr::experiment_mgr(xcs_configuration_manager &xcs_config, t_classifier_system *xcs, t_environment *environment, bool verbose)
 {
@@ -26,6 +29,21 @@ experiment_mgr::experiment_mgr(xcs_configuration_manager &xcs_config, t_classifi
 	xcs_config.check_parameters(tag_name(),configuration_parameters);
     set_parameters(xcs_config);
 
+	//! the copies of the environment are made once the environment has been configured
+	environments = NULL;
+	if (batch_size>1)
+	{
+		environments = new vector_env(*environment, batch_size);
+	}
+
+	snapshot_problem = 0;
+
+	//! test problems solved on a snapshot must not modify [P]
+	if (flag_concurrent_test && xcs->update_during_test_problems())
+	{
+		xcs_utility::error(class_name(), "constructor", "Concurrent test problems are not available when [P] is updated during test", 1);
+	}
+
     // PLL Not sure what these were used for
 	// current_experiment = -1;	//! to check whether the method reset_experiments is called
 	// current_problem = -1;		//! to check whether the method reset_problems is called
@@ -49,8 +67,19 @@ experiment_mgr::perform_experiments()
 	timer			timer_experiment;			//! measure the CPU time for one experiment
 	timer			timer_problem;				//! measure the CPU time for one problem
 
+	wall_timer		wall_overall;				//! measure the wall-clock time for all the experiments
+	wall_timer		wall_experiment;			//! measure the wall-clock time for one experiment
+	wall_timer		wall_problem;				//! measure the wall-clock time for one problem
+
 	vector<double>	experiment_time;			//! time elapsed for each experiment
 	vector<double>	problem_time;				//! time elapsed for problems
+	vector<double>	experiment_wall_time;		//! wall-clock time elapsed for each experiment
+
+	vector<latency_histogram>	experiment_learning_latency;	//! latency of the learning problems of each experiment
+	vector<latency_histogram>	experiment_testing_latency;		//! latency of the test problems of each experiment
+	vector<t_throughput>		experiment_throughput;			//! throughput and final population of each experiment
+	vector<xcs_memory_usage>	experiment_memory;				//! memory taken by the classifiers and the sets in each experiment
+	t_throughput				throughput;						//! throughput and final population of the current experiment
 
 	double			average_problem_time;		//! average time for problems
 	double			average_learning_time;		//! average time for learning
@@ -60,16 +89,66 @@ experiment_mgr::perform_experiments()
 	experiment_time.clear();
 	problem_time.clear();
 	timer_overall.start();
+	wall_overall.start();
+
+	//! the events of all the experiments are saved in one file, named after the first experiment
+	if (flag_event_trace)
+	{
+		char	fn_events[MSGSTR];
+
+		snprintf(fn_events, MSGSTR, "events.%s-%04ld.json", extension.c_str(), first_experiment);
+		xcs_event_trace::open(fn_events, event_trace_step_interval);
+	}
+
+	//! the progress is served on a local socket while the experiments go on
+	if (flag_live_metrics)
+	{
+		metrics.start("metrics."+extension+".sock");
+	}
+
+	/*!
+	 * the states, actions, and rewards of all the experiments are saved in one file, named after the
+	 * first experiment, which replay_env feeds back; only the problems solved one at a time by this
+	 * thread are recorded, since the others are solved on copies of the environment
+	 */
+	if (flag_record_stream)
+	{
+		char	fn_stream[MSGSTR];
+
+		if ((batch_size>1) || flag_concurrent_test)
+		{
+			xcs_utility::warning(class_name(), "perform_experiments", "the interaction stream is not recorded when the problems are solved in batches or concurrently");
+		} else {
+			if (environment->allow_test() && flag_test_environment)
+			{
+				xcs_utility::warning(class_name(), "perform_experiments", "the test of the whole environment is not recorded, thus the replay will not retrace the run");
+			}
+			snprintf(fn_stream, MSGSTR, "stream.%s-%04ld.bin", extension.c_str(), first_experiment);
+			stream.open(fn_stream, xcs_random::get_seed(), t_action().actions(), environment->single_step());
+		}
+	}
 	
+	//! the problems are enumerated once before learning, thus an environment too large to be enumerated stops the run before it begins rather than at the end of an experiment
+	if (environment->allow_test() && (flag_test_environment || flag_save_avf))
+	{
+		environment->reset_problem();
+	}
+
 	//! performs all the experiments, one by one.
 	for(current_experiment=first_experiment; current_experiment < (first_experiment+no_experiments); current_experiment++)
 	{
 
+		xcs_event_trace::span	trace_experiment("experiment", "experiment", "experiment", current_experiment);
+
 		//! true if condensation is active
 		bool flag_condensation = false;
 
-		//! init XCS for the current experiment
+		//! init XCS and the environment for the current experiment
 		xcs->begin_experiment();
+		environment->begin_experiment();
+		metrics.begin_experiment(current_experiment);
+		if (stream.is_open())
+			stream.begin_experiment(current_experiment);
 		
 		//! the first problem is always solved in exploration
 		bool flag_exploration = true;
@@ -132,8 +211,13 @@ experiment_mgr::perform_experiments()
 		
 		//! start timer for the experiment
 		timer_experiment.start();
+		wall_experiment.start();
 		average_problem_time = 0;
 
+		learning_latency.reset();
+		testing_latency.reset();
+		experiment_steps = 0;
+
 
 		current_no_test_problems = 0;
 
@@ -142,16 +226,47 @@ experiment_mgr::perform_experiments()
 			current_problem<first_learning_problem+2*(no_learning_problems+no_condensation_problems)+no_test_problems; 
 			current_problem++)
 		{
-			STATISTICS << current_experiment << '\t' << current_problem << '\t';
+			//! when problems are batched, the next problems are solved in lockstep
+			if (batch_size>1)
+			{
+				current_problem += perform_problem_batch(STATISTICS, TRACE, flag_exploration, average_problem_time) - 1;
+				continue;
+			}
+
+			//! with concurrent test problems, the test problems are solved by other threads on a snapshot of [P]
+			if (flag_concurrent_test)
+			{
+				if (current_problem>=(first_learning_problem+2*(no_learning_problems+no_condensation_problems)))	
+				{
+					flag_exploration = false;
+				}
+
+				if (!flag_exploration)
+				{
+					add_test_problem(current_problem);
+					flag_exploration = true;
+					save_intermediate(current_problem, flag_exploration);
+					continue;
+				}
+			}
+
+			//! the lines are queued when they must wait for the test problems before them
+			ostringstream	statistics_line;
+			ostringstream	trace_line;
+			ostream			&PROBLEM_STATISTICS = flag_concurrent_test ? (ostream&) statistics_line : (ostream&) STATISTICS;
+			ostream			&PROBLEM_TRACE = flag_concurrent_test ? (ostream&) trace_line : (ostream&) TRACE;
+
+			PROBLEM_STATISTICS << current_experiment << '\t' << current_problem << '\t';
 
 			//! if needed save information in the trace file
 			if (flag_trace)
 			{
-				TRACE << current_experiment << "\t" << current_problem << '\t';
+				PROBLEM_TRACE << current_experiment << "\t" << current_problem << '\t';
 			}
 			
 			//! start timer for problem
 			timer_problem.start();
+			wall_problem.start();
 
 			//! init XCS for the current problem
 			xcs->begin_problem();
@@ -167,16 +282,27 @@ experiment_mgr::perform_experiments()
 				flag_exploration = false;
 			}
 			
+			xcs_event_trace::span	trace_problem(flag_exploration ? "learning problem" : "test problem", "problem", "problem", current_problem);
+
 			//! init the environment for the current problem
-			environment->begin_problem(flag_exploration);
+			begin_environment_problem(flag_exploration);
 
 			reward_sum = 0;
 			problem_steps = 0;
 			do 
 			{			
+				//! the state is read before the step, since the step may change it
+				string	recorded_state;
+
+				if (stream.is_open())
+					recorded_state = environment->state().string_value();
+
 				//! XCS executes one step
 				xcs->step(flag_exploration,flag_condensation);
 				problem_steps++;
+
+				if (stream.is_open())
+					stream.step(recorded_state, xcs->performed_action(), environment->reward(), environment->stop(), xcs->performed_draws());
 				
 				//! sum up the reward received
 				reward_sum = reward_sum + environment->reward();
@@ -193,7 +319,7 @@ experiment_mgr::perform_experiments()
 					if ((problem_steps>0) && (problem_steps%teletransportation_interval==0))
 					{
 						xcs->begin_problem();
-						environment->begin_problem(flag_exploration);
+						begin_environment_problem(flag_exploration);
 					}
 				}
 			} 
@@ -201,8 +327,15 @@ experiment_mgr::perform_experiments()
 
 			//! stops the timer for the problem
 			timer_problem.stop();
+			wall_problem.stop();
 			average_problem_time += timer_problem.elapsed();
 
+			if (flag_exploration)
+				learning_latency.record(wall_problem.elapsed_ns());
+			else
+				testing_latency.record(wall_problem.elapsed_ns());
+			experiment_steps += problem_steps;
+
 			//! problem trace information is saved
 			/*! by default the statistics file contain (for each line)
 			 *  - experiment number
@@ -215,12 +348,12 @@ experiment_mgr::perform_experiments()
 			if (flag_trace) 
 			{
 				//! save trace information
-				xcs->trace(TRACE);
-				environment->trace(TRACE);
+				xcs->trace(PROBLEM_TRACE);
+				environment->trace(PROBLEM_TRACE);
 				if (flag_exploration)
-					TRACE << "\t" << "Learning" << endl;
+					PROBLEM_TRACE << "\t" << "Learning" << endl;
 				else 
-					TRACE << "\t" << "Testing" << endl;
+					PROBLEM_TRACE << "\t" << "Testing" << endl;
 			}
 
 			//! XCS ends the current problem
@@ -239,41 +372,34 @@ experiment_mgr::perform_experiments()
 			 *  - "Learning/Testing" whether the problem has been solved in learning or testing mode
 			 */
 
-			STATISTICS << problem_steps << '\t';
-			STATISTICS << reward_sum << '\t';
-			STATISTICS << xcs->size() << '\t';
+			PROBLEM_STATISTICS << problem_steps << '\t';
+			PROBLEM_STATISTICS << reward_sum << '\t';
+			PROBLEM_STATISTICS << xcs->size() << '\t';
 
 			//! if the environment is single step, it saves the system_error
 			if (environment->single_step())
 			{
-				STATISTICS << xcs->get_system_error() << "\t";
+				PROBLEM_STATISTICS << xcs->get_system_error() << "\t";
 			}
-			STATISTICS << (flag_exploration ? "Learning" : "Testing") << endl;
-			// }
-		
-			//! it switches from exploration to exploitation and viceversa
-			flag_exploration = !flag_exploration;
-
-			//! save intermediate experiment states
-			unsigned long no_problems_so_far = current_problem-first_learning_problem;
-			
-			if ((no_problems_so_far>0) && save_experiment_interval!=0)
+			if (flag_population_statistics)
 			{
-				if (no_problems_so_far%save_experiment_interval==0)
-				{
-					save_state((current_experiment), flag_exploration, current_problem);
-				}
+				xcs->statistics().write_columns(PROBLEM_STATISTICS);
 			}
+			PROBLEM_STATISTICS << (flag_exploration ? "Learning" : "Testing") << endl;
+			// }
 
-			//! save intermediate populations
-			if ((no_problems_so_far>0) && save_population_interval!=0)
+			metrics.problem(current_problem, flag_exploration, problem_steps, reward_sum, (environment->single_step() ? xcs->get_system_error() : 0), wall_problem.elapsed_ns(), xcs->size(), xcs->micro_size(), xcs->profile());
+
+			if (flag_concurrent_test)
 			{
-				// cout << "SAVE POPULATION INTERVAL " << save_population_interval << endl;
-				if (no_problems_so_far%save_population_interval==0)
-				{
-					save_population((current_experiment), current_problem);
-				}
+				add_output(statistics_line.str(), trace_line.str(), STATISTICS, TRACE);
 			}
+		
+			//! it switches from exploration to exploitation and viceversa
+			flag_exploration = !flag_exploration;
+
+			//! save intermediate experiment states and populations
+			save_intermediate(current_problem, flag_exploration);
 
 			if (!flag_exploration)
 			{
@@ -283,12 +409,26 @@ experiment_mgr::perform_experiments()
 
 		} //!< end learning/testing problems
 
+		//! the test problems still running are completed before the statistics go on
+		if (flag_concurrent_test)
+		{
+			flush_output(STATISTICS, TRACE, true);
+		}
+
 		//! stops the experimnt timer
 		timer_experiment.stop();
+		wall_experiment.stop();
 
 		//! memorize the time used in this experiment
 		experiment_time.push_back(timer_experiment.elapsed());
 		problem_time.push_back(average_problem_time/(no_learning_problems+no_condensation_problems+no_test_problems));
+		experiment_wall_time.push_back(wall_experiment.elapsed());
+		experiment_learning_latency.push_back(learning_latency);
+		experiment_testing_latency.push_back(testing_latency);
+
+		//! the test of the environment is not timed, thus its steps are not counted
+		throughput.steps = experiment_steps;
+		throughput.problems = learning_latency.count()+testing_latency.count();
 
 		/*!
 		 *
@@ -299,7 +439,11 @@ experiment_mgr::perform_experiments()
 		 *
 		 */
 
-		if (environment->allow_test() && flag_test_environment)
+		if (environment->allow_test() && flag_test_environment && flag_parallel_test_environment)
+		{
+			flag_exploration = false;
+			perform_parallel_test_environment(STATISTICS, TRACE);
+		} else if (environment->allow_test() && flag_test_environment)
 		{
 			environment->reset_problem();
 
@@ -389,6 +533,10 @@ experiment_mgr::perform_experiments()
 					{
 						STATISTICS << xcs->get_system_error() << "\t";
 					}
+					if (flag_population_statistics)
+					{
+						xcs->statistics().write_columns(STATISTICS);
+					}
 					STATISTICS << (flag_exploration ? "Learning" : "Solution") << endl;
 		
 					///==============================================================================
@@ -404,20 +552,41 @@ experiment_mgr::perform_experiments()
 
 		//! stop the timer for the whole session
 		timer_overall.stop();
+		wall_overall.stop();
+
+		//! the time spent in each phase is saved when the instrumentation is compiled
+		if (xcs_profiler::enabled)
+		{
+			save_profile_report(current_experiment);
+		}
+
+		//! the final population is summarized by a fingerprint, so runs with the same seed can be compared
+		struct rusage	usage;
 
-		//! XCS ends the experiment
+		getrusage(RUSAGE_SELF, &usage);
+		throughput.peak_rss = usage.ru_maxrss;
+		throughput.fingerprint = xcs->fingerprint();
+		experiment_throughput.push_back(throughput);
+		experiment_memory.push_back(xcs->memory_usage());
+
+		//! XCS and the environment end the experiment
 		xcs->end_experiment();
+		environment->end_experiment();
 		
 		//! at the end of the experiment the file for statistics is closed and gzipped
-		STATISTICS.close();
-		snprintf(system_command, MSGSTR, "gzip -f %s", fn_statistics);
-		system(system_command);
-	
-		if (flag_trace)
 		{
-			TRACE.close();
-			snprintf(system_command, MSGSTR, "gzip -f %s", fn_trace);
+			xcs_event_trace::span	trace_compress("compress statistics", "io");
+
+			STATISTICS.close();
+			snprintf(system_command, MSGSTR, "gzip -f %s", fn_statistics);
 			system(system_command);
+	
+			if (flag_trace)
+			{
+				TRACE.close();
+				snprintf(system_command, MSGSTR, "gzip -f %s", fn_trace);
+				system(system_command);
+			}
 		}
 
 		//! save requested information about the experiment.
@@ -439,13 +608,594 @@ experiment_mgr::perform_experiments()
 
 	}
 
+	//! the last action-value function must be completely written before returning
+	{
+		xcs_event_trace::span	trace_wait("wait action-value function", "wait");
+
+		wait_avf();
+	}
+
 	if (flag_save_time_report)
 	{
-        save_time_report(timer_overall, experiment_time, problem_time);
+        save_time_report(timer_overall, experiment_time, problem_time, wall_overall, experiment_wall_time, experiment_learning_latency, experiment_testing_latency, experiment_throughput, experiment_memory);
     }
+
+	metrics.stop();
+
+	stream.close();
+
+	xcs_event_trace::close();
+}
+
+unsigned long
+experiment_mgr::perform_problem_batch(ofstream &STATISTICS, ofstream &TRACE, bool &flag_exploration, double &problem_time)
+{
+	timer			timer_batch;				//! measure the CPU time for the batch
+	wall_timer		wall_batch;					//! measure the wall-clock time for the batch
+
+	unsigned long	learning_end = first_learning_problem+2*no_learning_problems;
+	unsigned long	condensation_end = learning_end+2*no_condensation_problems;
+	unsigned long	last_problem = condensation_end+no_test_problems;
+
+	//! a batch does not cross the end of the learning and condensation problems, thus all its problems share the same condensation mode
+	unsigned long	phase_end = (current_problem<learning_end) ? learning_end : ((current_problem<condensation_end) ? condensation_end : last_problem);
+	unsigned long	no_problems = min(batch_size, phase_end-current_problem);
+
+	bool			flag_condensation = ((no_condensation_problems>0) && (current_problem>=learning_end));
+
+	xcs_event_trace::span	trace_batch("problem batch", "problem", "problems", no_problems);
+
+	vector<bool>	running(batch_size, false);		//! true if the episode is still running
+	vector<bool>	exploration(batch_size, false);		//! true if the episode is solved in exploration
+	vector<long>	problem_steps(batch_size, 0);		//! number of steps needed to solve each problem
+	vector<double>	reward_sum(batch_size, 0);		//! sum of rewards gained while solving each problem
+
+	//! [P] changes until the last episode of the batch ends, thus it is recorded when each episode ends
+	vector<unsigned long>	population_size(batch_size, 0);		//! size of [P] in macroclassifiers
+	vector<unsigned long>	micro_size(batch_size, 0);			//! size of [P] in microclassifiers
+	vector<xcs_statistics>	population_statistics(flag_population_statistics ? batch_size : 0);
+	vector<string>			xcs_trace(flag_trace ? batch_size : 0);
+
+	timer_batch.start();
+	wall_batch.start();
+
+	xcs->begin_batch(batch_size);
+
+	//! problems alternate exploration and exploitation as when they are solved one by one
+	for(unsigned long i=0; i<no_problems; i++)
+	{
+		if (current_problem+i>=condensation_end)
+		{
+			flag_exploration = false;
+		}
+		exploration[i] = flag_exploration;
+		flag_exploration = !flag_exploration;
+
+		running[i] = true;
+		(*environments)[i].begin_problem(exploration[i]);
+	}
+
+	bool flag_running;
+	do
+	{
+		//! XCS executes one step of every running episode
+		xcs->step(*environments, running, exploration, flag_condensation);
+
+		flag_running = false;
+		for(unsigned long i=0; i<no_problems; i++)
+		{
+			if (running[i])
+			{
+				problem_steps[i]++;
+				reward_sum[i] = reward_sum[i] + (*environments)[i].reward();
+				running[i] = ((problem_steps[i]<no_max_steps) && (!(*environments)[i].stop()));
+				flag_running = flag_running || running[i];
+
+				if (!running[i])
+				{
+					population_size[i] = xcs->size();
+					micro_size[i] = xcs->micro_size();
+					if (flag_population_statistics)
+						population_statistics[i] = xcs->statistics();
+					if (flag_trace)
+					{
+						ostringstream	trace;
+
+						xcs->trace(trace);
+						xcs_trace[i] = trace.str();
+					}
+				}
+			}
+		}
+	}
+	while (flag_running);
+
+	timer_batch.stop();
+	wall_batch.stop();
+	problem_time += timer_batch.elapsed();
+
+	//! the problems of a batch are solved together, thus each one is charged an equal share of the batch
+	for(unsigned long i=0; i<no_problems; i++)
+	{
+		if (exploration[i])
+			learning_latency.record(wall_batch.elapsed_ns()/no_problems);
+		else
+			testing_latency.record(wall_batch.elapsed_ns()/no_problems);
+		experiment_steps += problem_steps[i];
+	}
+
+	//! problem statistics are saved in the problem order, as when problems are solved one by one
+	for(unsigned long i=0; i<no_problems; i++)
+	{
+		STATISTICS << current_experiment << '\t' << current_problem+i << '\t';
+
+		if (flag_trace) 
+		{
+			TRACE << current_experiment << "\t" << current_problem+i << '\t';
+			TRACE << xcs_trace[i];
+			(*environments)[i].trace(TRACE);
+			if (exploration[i])
+				TRACE << "\t" << "Learning" << endl;
+			else 
+				TRACE << "\t" << "Testing" << endl;
+		}
+
+		STATISTICS << problem_steps[i] << '\t';
+		STATISTICS << reward_sum[i] << '\t';
+		STATISTICS << population_size[i] << '\t';
+
+		if ((*environments)[i].single_step())
+		{
+			STATISTICS << xcs->get_system_error(i) << "\t";
+		}
+		if (flag_population_statistics)
+		{
+			population_statistics[i].write_columns(STATISTICS);
+		}
+		STATISTICS << (exploration[i] ? "Learning" : "Testing") << endl;
+
+		metrics.problem(current_problem+i, exploration[i], problem_steps[i], reward_sum[i], ((*environments)[i].single_step() ? xcs->get_system_error(i) : 0), wall_batch.elapsed_ns()/no_problems, population_size[i], micro_size[i], xcs->profile());
+
+		if (exploration[i])
+		{
+			current_no_test_problems++;
+		}
+	}
+
+	//! [P] is known only at the end of the batch, thus it is saved once under the last problem of the batch
+	save_intermediate(current_problem+no_problems-1, !exploration[no_problems-1], no_problems);
+
+	xcs->end_batch();
+	environments->end_problem();
+
+	return no_problems;
+}
+
+/*!
+ * The initial configurations are enumerated on the main thread in rounds: the environment is copied
+ * at each configuration and the copies are solved by the pool of threads on the same copy of [P].
+ * Each episode has its own seed, drawn from the generator of the main thread, thus the results do
+ * not depend on the number of threads; they are saved in the order of the configurations, i.e., of
+ * current_problem. As in the serial test, an episode that exceeds the maximum number of steps goes
+ * on with random actions and it is labeled as Learning; however [P] is never modified.
+ */
+void
+experiment_mgr::perform_parallel_test_environment(ofstream &STATISTICS, ofstream &TRACE)
+{
+	//! an episode of the test
+	struct t_episode {
+		shared_ptr<t_environment>	environment;	//!< copy of the environment in the initial configuration
+		unsigned long	seed;				//!< seed of the random number generator used to solve the episode
+		long			steps;				//!< number of steps needed to solve the episode
+		double			reward_sum;			//!< sum of rewards gained while solving the episode
+		double			system_error;		//!< system error of the last step, for single step environments
+		bool			exploration;		//!< true if the maximum number of steps was exceeded
+		string			trace;				//!< trace information from the environment
+	};
+
+	const unsigned long	round_size = 256*no_threads;	//! episodes copied and solved together
+	t_action			action;
+	unsigned long		no_actions = action.actions();
+	vector<t_state>		start_states;
+	bool				flag_next = true;
+
+	xcs_event_trace::span	trace_test("test environment", "problem");
+
+	//! a frozen population is verified on the initial configurations of the sweep, since the states met later are not known in advance
+	if (flag_freeze_population && flag_verify_frozen_population)
+	{
+		environment->reset_problem();
+		do {
+			start_states.push_back(environment->state());
+		} while (environment->next_problem());
+	}
+
+	t_predictor			predictor = population_predictor(start_states);
+
+	environment->reset_problem();
+
+	while (flag_next)
+	{
+		vector<t_episode>	episodes;
+
+		while (flag_next && (episodes.size()<round_size))
+		{
+			t_episode	episode;
+
+			episode.environment.reset(new t_environment(*environment));
+			episode.seed = xcs_random::bits();
+			episode.steps = 0;
+			episode.reward_sum = 0;
+			episode.system_error = 0;
+			episode.exploration = false;
+			episodes.push_back(episode);
+
+			flag_next = environment->next_problem();
+		}
+
+		atomic<unsigned long>	next_episode(0);
+		vector<std::thread>		pool;
+
+		for(unsigned long t=0; t<min(no_threads, (unsigned long) episodes.size()); t++)
+		{
+			pool.push_back(std::thread([&]() {
+				xcs_event_trace::span	trace_episodes("test episodes", "problem", "episodes", 0);
+				vector<t_state>	input(1);
+				vector<double>	prediction;
+				vector<bool>	matched;
+				unsigned long	no_solved = 0;
+
+				for(unsigned long e=next_episode++; e<episodes.size(); e=next_episode++)
+				{
+					t_episode		&episode = episodes[e];
+					t_environment	&copy = *episode.environment;
+
+					xcs_random::set_seed(episode.seed);
+
+					do
+					{
+						if (episode.steps>(long) no_max_steps)
+						{
+							episode.exploration = true;
+						}
+
+						input[0] = copy.state();
+						predictor(input, prediction, matched);
+
+						unsigned long	act = episode.exploration ? xcs_random::dice(no_actions) : greedy_action(prediction, matched, no_actions);
+
+						copy.perform(t_action(act));
+
+						if (copy.single_step())
+						{
+							episode.system_error = fabs(prediction[act]-copy.reward());
+						}
+
+						episode.steps++;
+						episode.reward_sum = episode.reward_sum + copy.reward();
+					}
+					while (!copy.stop());
+
+					ostringstream	trace;
+
+					copy.trace(trace);
+					episode.trace = trace.str();
+
+					copy.end_problem();
+					episode.environment.reset();
+					no_solved++;
+				}
+				trace_episodes.set_argument(no_solved);
+			}));
+		}
+
+		for(unsigned long t=0; t<pool.size(); t++)
+		{
+			pool[t].join();
+		}
+
+		//! the episodes are saved as in the serial test of the environment
+		for(vector<t_episode>::const_iterator episode=episodes.begin(); episode!=episodes.end(); episode++)
+		{
+			if (episode->exploration)
+			{
+				cerr << ">> Maximum number of steps reached during testing the environment. Exploration activated." << endl;
+			}
+
+			STATISTICS << current_experiment << '\t' << current_problem << '\t';
+
+			if (flag_trace) 
+			{
+				TRACE << current_experiment << "\t" << current_problem << '\t';
+				TRACE << episode->trace;
+				TRACE << "\t" << (episode->exploration ? "Learning" : "Solution") << endl;
+			}
+
+			STATISTICS << episode->steps << '\t';
+			STATISTICS << episode->reward_sum << '\t';
+			STATISTICS << xcs->size() << '\t';
+			if (environment->single_step())
+			{
+				STATISTICS << episode->system_error << "\t";
+			}
+			if (flag_population_statistics)
+			{
+				xcs->statistics().write_columns(STATISTICS);
+			}
+			STATISTICS << (episode->exploration ? "Learning" : "Solution") << endl;
+
+			current_problem++;
+		}
+	}
+}
+
+/*!
+ * The snapshot and the copy of the environment are taken on the main thread, so that the workers
+ * never access [P] or the environment used for learning. The seed of each test problem is drawn
+ * from the generator of the main thread, thus the results do not depend on how the batches are
+ * scheduled on the workers.
+ */
+void
+experiment_mgr::add_test_problem(const unsigned long problem_no)
+{
+	bool	flag_new_snapshot = test_batches.empty() || test_batches.back().worker.joinable() || (problem_no>=snapshot_problem+test_snapshot_interval);
+
+	if (flag_new_snapshot)
+	{
+		//! the batch collecting problems on the previous snapshot is started
+		if (!test_batches.empty() && !test_batches.back().worker.joinable())
+		{
+			start_test_batch(test_batches.back());
+		}
+
+		test_batches.emplace_back();
+
+		t_test_batch	&batch = test_batches.back();
+
+		xcs_event_trace::span	trace_snapshot("snapshot", "snapshot", "problem", problem_no);
+
+		batch.snapshot.reset(new population_snapshot());
+		xcs->snapshot(*batch.snapshot);
+		batch.environment.reset(new t_environment(*environment));
+		batch.done = false;
+		snapshot_problem = problem_no;
+	}
+
+	t_test_batch	&batch = test_batches.back();
+	t_test_problem	problem;
+
+	problem.problem = problem_no;
+	problem.seed = xcs_random::bits();
+	problem.population_size = xcs->size();
+	problem.statistics = xcs->statistics();
+	problem.steps = 0;
+	problem.reward_sum = 0;
+	problem.system_error = 0;
+	problem.latency = 0;
+	batch.problems.push_back(problem);
+
+	t_pending_output	output;
+
+	output.batch = &batch;
+	output.index = batch.problems.size()-1;
+	pending_output.push_back(output);
+}
+
+void
+experiment_mgr::add_output(const string& statistics, const string& trace, ofstream &STATISTICS, ofstream &TRACE)
+{
+	t_pending_output	output;
+
+	output.batch = NULL;
+	output.index = 0;
+	output.statistics = statistics;
+	output.trace = trace;
+	pending_output.push_back(output);
+
+	flush_output(STATISTICS, TRACE, false);
+}
+
+/*!
+ * test problems are saved as when they are solved one by one, except that the population size
+ * is the one of the snapshot; the trace information comes from the copy of the environment
+ */
+void
+experiment_mgr::flush_output(ofstream &STATISTICS, ofstream &TRACE, const bool flag_wait)
+{
+	if (flag_wait)
+	{
+		if (!test_batches.empty() && !test_batches.back().worker.joinable())
+		{
+			start_test_batch(test_batches.back());
+		}
+
+		xcs_event_trace::span	trace_wait("wait test batches", "wait");
+
+		for(list<t_test_batch>::iterator batch=test_batches.begin(); batch!=test_batches.end(); batch++)
+		{
+			if (batch->worker.joinable())
+				batch->worker.join();
+		}
+	}
+
+	//! only the calls that write some lines are traced
+	uint64_t		flush_start = xcs_event_trace::is_open() ? xcs_event_trace::now() : 0;
+	unsigned long	no_lines = 0;
+
+	while (!pending_output.empty() && ((pending_output.front().batch==NULL) || pending_output.front().batch->done))
+	{
+		const t_pending_output	&output = pending_output.front();
+
+		if (output.batch==NULL)
+		{
+			STATISTICS << output.statistics;
+			if (flag_trace)
+				TRACE << output.trace;
+		} else {
+			const t_test_problem	&problem = output.batch->problems[output.index];
+
+			testing_latency.record(problem.latency);
+			experiment_steps += problem.steps;
+
+			STATISTICS << current_experiment << '\t' << problem.problem << '\t';
+			STATISTICS << problem.steps << '\t';
+			STATISTICS << problem.reward_sum << '\t';
+			STATISTICS << problem.population_size << '\t';
+			if (environment->single_step())
+			{
+				STATISTICS << problem.system_error << "\t";
+			}
+			if (flag_population_statistics)
+			{
+				problem.statistics.write_columns(STATISTICS);
+			}
+			STATISTICS << "Testing" << endl;
+
+			metrics.problem(problem.problem, false, problem.steps, problem.reward_sum, problem.system_error, problem.latency, xcs->size(), xcs->micro_size(), xcs->profile());
+
+			if (flag_trace)
+			{
+				TRACE << current_experiment << "\t" << problem.problem << '\t';
+				TRACE << problem.trace;
+				TRACE << "\t" << "Testing" << endl;
+			}
+		}
+
+		pending_output.pop_front();
+		no_lines++;
+	}
+	if (no_lines>0)
+		xcs_event_trace::complete("flush output", "io", flush_start, "lines", no_lines);
+
+	//! the batches whose lines have all been written are released
+	while (!test_batches.empty() && test_batches.front().worker.joinable() && test_batches.front().done)
+	{
+		test_batches.front().worker.join();
+		test_batches.pop_front();
+	}
+}
+
+void
+experiment_mgr::start_test_batch(t_test_batch &batch)
+{
+	unsigned long	no_running = 0;
+
+	for(list<t_test_batch>::iterator running=test_batches.begin(); running!=test_batches.end(); running++)
+	{
+		if (running->worker.joinable() && !running->done)
+			no_running++;
+	}
+
+	//! when all the threads are busy, the learning waits for the oldest batch
+	for(list<t_test_batch>::iterator running=test_batches.begin(); (no_running>=no_threads) && (running!=test_batches.end()); running++)
+	{
+		if (running->worker.joinable() && !running->done)
+		{
+			xcs_event_trace::span	trace_wait("wait test batch", "wait");
+
+			running->worker.join();
+			no_running--;
+		}
+	}
+
+	batch.worker = std::thread([this, &batch]() { solve_test_batch(batch); });
+}
+
+/*!
+ * each problem is solved as an exploitation problem, i.e., the action with the highest prediction
+ * is selected; the snapshot cannot be covered, thus a random action is performed when no classifier
+ * matches \sa greedy_action
+ */
+void
+experiment_mgr::solve_test_batch(t_test_batch &batch) const
+{
+	t_environment	&environment = *batch.environment;
+	unsigned long	no_actions = batch.snapshot->actions();
+	vector<t_state>	input(1);
+	vector<double>	prediction;
+	vector<bool>	matched;
+
+	xcs_event_trace::span	trace_batch("test batch", "problem", "problems", batch.problems.size());
+
+	for(vector<t_test_problem>::iterator problem=batch.problems.begin(); problem!=batch.problems.end(); problem++)
+	{
+		wall_timer	wall_problem;
+
+		wall_problem.start();
+		xcs_random::set_seed(problem->seed);
+
+		environment.begin_problem(false);
+
+		do
+		{
+			input[0] = environment.state();
+			batch.snapshot->predict(input, prediction, matched);
+
+			unsigned long	action = greedy_action(prediction, matched, no_actions);
+
+			environment.perform(t_action(action));
+
+			if (environment.single_step())
+			{
+				problem->system_error = fabs(prediction[action]-environment.reward());
+			}
+
+			problem->steps++;
+			problem->reward_sum = problem->reward_sum + environment.reward();
+		}
+		while ((problem->steps<(long) no_max_steps) && (!environment.stop()));
+
+		ostringstream	trace;
+
+		environment.trace(trace);
+		problem->trace = trace.str();
+
+		environment.end_problem();
+
+		wall_problem.stop();
+		problem->latency = wall_problem.elapsed_ns();
+	}
+
+	batch.done = true;
+}
+
+void
+experiment_mgr::save_intermediate(const unsigned long problem_no, const bool flag_exploration, const unsigned long no_problems) const
+{
+	unsigned long no_problems_so_far = problem_no-first_learning_problem;
+	unsigned long no_problems_before = (no_problems_so_far>no_problems) ? no_problems_so_far-no_problems : 0;
+	
+	//! save intermediate experiment states
+	if ((no_problems_so_far>0) && save_experiment_interval!=0)
+	{
+		if (no_problems_so_far/save_experiment_interval!=no_problems_before/save_experiment_interval)
+		{
+			save_state((current_experiment), flag_exploration, problem_no);
+		}
+	}
+
+	//! save intermediate populations
+	if ((no_problems_so_far>0) && save_population_interval!=0)
+	{
+		if (no_problems_so_far/save_population_interval!=no_problems_before/save_population_interval)
+		{
+			save_population((current_experiment), problem_no);
+		}
+	}
 }
 
-void experiment_mgr::save_time_report(timer &timer_overall, std::vector<double> &experiment_time, std::vector<double> &problem_time)
+/*!
+ * Besides the CPU time, the report contains the wall-clock time of the whole session and of each
+ * experiment, and the latency of the learning and test problems of each experiment, i.e., the
+ * number of problems, the mean, the 50th, 90th, and 99th percentiles, and the maximum wall-clock
+ * time spent to solve a problem, in milliseconds. The throughput is the number of steps and of
+ * problems per second of wall-clock time; it is reported with the peak resident set size and the
+ * fingerprint of the final population, which must not change when the same configuration is run
+ * with the same seed by a faster build. The memory section accounts the bytes of the classifiers
+ * at the end and at the peak of each experiment, the peak size of [P], the classifiers allocated
+ * and freed, the size of [M] and [A], and the vectors that implement the sets \sa xcs_memory_usage
+ */
+void experiment_mgr::save_time_report(timer &timer_overall, std::vector<double> &experiment_time, std::vector<double> &problem_time, wall_timer &wall_overall, std::vector<double> &experiment_wall_time, std::vector<latency_histogram> &experiment_learning_latency, std::vector<latency_histogram> &experiment_testing_latency, std::vector<t_throughput> &experiment_throughput, std::vector<xcs_memory_usage> &experiment_memory)
 {
     //! init the file for statistics
     ofstream REPORT;
@@ -460,11 +1210,51 @@ void experiment_mgr::save_time_report(timer &timer_overall, std::vector<double>
     }
 
     REPORT << "TOTAL ELAPSED TIME\t\t" << setprecision(4) << timer_overall.elapsed() << endl;
+    REPORT << "TOTAL WALL-CLOCK TIME\t\t" << setprecision(4) << wall_overall.elapsed() << endl;
     for (unsigned long exp = first_experiment; exp < (first_experiment + no_experiments); exp++)
     {
         REPORT << "Experiment\t" << setw(5) << exp << "\t";
         REPORT << "Total\t" << experiment_time[exp - first_experiment] << "\t";
         REPORT << "AveragePerProblem\t" << problem_time[exp - first_experiment] << "\t";
+        REPORT << "WallClock\t" << setprecision(4) << experiment_wall_time[exp - first_experiment] << "\t";
+        REPORT << endl;
+    }
+
+    REPORT << endl;
+    REPORT << "PROBLEM LATENCY (ms)\t\t\tProblems\tMean\tp50\tp90\tp99\tMax" << endl;
+    for (unsigned long exp = first_experiment; exp < (first_experiment + no_experiments); exp++)
+    {
+        REPORT << "Experiment\t" << setw(5) << exp << "\t" << "Learning\t";
+        experiment_learning_latency[exp - first_experiment].print(REPORT);
+        REPORT << endl;
+        REPORT << "Experiment\t" << setw(5) << exp << "\t" << "Testing\t";
+        experiment_testing_latency[exp - first_experiment].print(REPORT);
+        REPORT << endl;
+    }
+
+    REPORT << endl;
+    REPORT << "THROUGHPUT\t\t\tSteps\tProblems\tStepsPerSecond\tProblemsPerSecond\tPeakRSS(KB)\tFingerprint" << endl;
+    for (unsigned long exp = first_experiment; exp < (first_experiment + no_experiments); exp++)
+    {
+        const t_throughput&	throughput = experiment_throughput[exp - first_experiment];
+        double				wall_time = max(experiment_wall_time[exp - first_experiment], 1e-9);
+
+        REPORT << "Experiment\t" << setw(5) << exp << "\t";
+        REPORT << throughput.steps << "\t" << throughput.problems << "\t";
+        REPORT << fixed << setprecision(1) << throughput.steps/wall_time << "\t" << throughput.problems/wall_time << "\t";
+        REPORT.unsetf(ios::floatfield);
+        REPORT << throughput.peak_rss << "\t";
+        REPORT << hex << setfill('0') << setw(16) << throughput.fingerprint << dec << setfill(' ') << endl;
+    }
+
+    REPORT << endl;
+    REPORT << "MEMORY\t\t\t";
+    xcs_memory_usage::print_header(REPORT);
+    REPORT << endl;
+    for (unsigned long exp = first_experiment; exp < (first_experiment + no_experiments); exp++)
+    {
+        REPORT << "Experiment\t" << setw(5) << exp << "\t";
+        experiment_memory[exp - first_experiment].print(REPORT);
         REPORT << endl;
     }
 
@@ -473,6 +1263,27 @@ void experiment_mgr::save_time_report(timer &timer_overall, std::vector<double>
     REPORT.close();
 };
 
+void
+experiment_mgr::save_profile_report(const unsigned long expNo) const
+{
+	ofstream	REPORT;
+	char		filename_report[MSGSTR];
+
+	snprintf(filename_report, MSGSTR, "report.%s-%04ld", extension.c_str(), expNo);
+
+	REPORT.open(filename_report, ios::out | ios::app);
+	if (!REPORT.good())
+	{
+		xcs_utility::error(class_name(), "save_profile_report", "Report file '"+string(filename_report)+"' not open", 1);
+	}
+
+	REPORT << "STEP PROFILE\t\tExperiment\t" << setw(5) << expNo << endl;
+	xcs->profile().print(REPORT);
+	REPORT << "----------------------------------------------------------------------------------------------------" << endl;
+	REPORT << endl << endl;
+	REPORT.close();
+}
+
 void	
 experiment_mgr::print_save_options(ostream& output) 
 const
@@ -497,6 +1308,8 @@ experiment_mgr::save_population(const unsigned long current_experiment, const un
 	char		filename[MSGSTR];
 	char		system_command[MSGSTR];
 
+	xcs_event_trace::span	trace_save("save population", "io", "problem", problem_no);
+
 	clog << "\t" << current_experiment+1 << "/" << first_experiment+no_experiments << "\t";
 	clog << "saving the final population ...";
 
@@ -529,6 +1342,8 @@ experiment_mgr::save_state(const unsigned long expNo, const bool flag_exploratio
 	char		filename[MSGSTR];
 	char		system_command[MSGSTR];	// string for system calls
 
+	xcs_event_trace::span	trace_save("save state", "io", "problem", problem_no);
+
 	clog << "\t" << current_experiment+1 << "/" << first_experiment+no_experiments << "\t";
 	clog << "saving the experiment final state ...";
 
@@ -681,13 +1496,71 @@ void experiment_mgr::set_parameters(xcs_configuration_manager &xcs_config)
     // xcs_utility::set_flag(string(str_test_environment), flag_test_environment);
 	xcs_utility::set_flag(xcs_config.Value(tag_name(), "test environment", "off"), flag_test_environment);
 
+	//! the whole environment is tested by several threads on a copy of [P]
+	xcs_utility::set_flag(xcs_config.Value(tag_name(), "parallel test environment", "off"), flag_parallel_test_environment);
+
     //! saves execution time
 	// string str_trace_time = (string)xcs_config.Value(tag_name(), "trace time", "on");
 	// xcs_utility::set_flag(string(str_trace_time), flag_save_time_report);
 	xcs_utility::set_flag(xcs_config.Value(tag_name(), "save execution time report", "on"), flag_save_time_report);	
+	xcs_utility::set_flag(xcs_config.Value(tag_name(), "save population statistics", "off"), flag_population_statistics);
+
+	//! saves the timed events of all the threads in the Chrome trace format
+	xcs_utility::set_flag(xcs_config.Value(tag_name(), "save event trace", "off"), flag_event_trace);
+	event_trace_step_interval = xcs_config.Value(tag_name(), "event trace step interval", (unsigned long)100);
+
+	//! serves the progress of the run on the Unix domain socket metrics.<ext>.sock
+	xcs_utility::set_flag(xcs_config.Value(tag_name(), "live metrics", "off"), flag_live_metrics);
+
+	//! saves the interaction with the environment in stream.<ext>-<first experiment>.bin
+	xcs_utility::set_flag(xcs_config.Value(tag_name(), "record interaction stream", "off"), flag_record_stream);
 
     //! saves action value function
 	xcs_utility::set_flag(xcs_config.Value(tag_name(), "save action-value function", "off"), flag_save_avf);	
+
+	//! compiles [P] before saving the action value function
+	xcs_utility::set_flag(xcs_config.Value(tag_name(), "freeze population", "off"), flag_freeze_population);
+
+	//! checks the frozen population against [P] on the states it is used for, which scans [P] for each of them
+	xcs_utility::set_flag(xcs_config.Value(tag_name(), "verify frozen population", "off"), flag_verify_frozen_population);
+
+	//! format of the action value function, compressed text or binary
+	string str_avf_format = (string)xcs_config.Value(tag_name(), "action-value function format", "text");
+	if (str_avf_format!="text" && str_avf_format!="binary")
+	{
+		xcs_utility::error(class_name(), "constructor", "Action-value function format must be text or binary", 1);
+	}
+	flag_binary_avf = (str_avf_format=="binary");
+
+	//! threads used to evaluate snapshots of [P]
+	no_threads = xcs_config.Value(tag_name(), "number of threads", (unsigned long)0);
+	if (no_threads==0)
+	{
+		no_threads = max(1U, std::thread::hardware_concurrency());
+	}
+
+	//! number of problems solved in lockstep
+	batch_size = xcs_config.Value(tag_name(), "batch size", (unsigned long)1);
+	if (batch_size==0)
+	{
+		xcs_utility::error(class_name(), "constructor", "Batch size must be at least 1", 1);
+	}
+	if (batch_size>1 && teletransportation_interval!=0)
+	{
+		xcs_utility::error(class_name(), "constructor", "Teletransportation is not available when problems are batched", 1);
+	}
+
+	//! test problems solved by other threads on a snapshot of [P]
+	xcs_utility::set_flag(xcs_config.Value(tag_name(), "concurrent test problems", "off"), flag_concurrent_test);
+	test_snapshot_interval = xcs_config.Value(tag_name(), "test snapshot interval", (unsigned long)100);
+	if (test_snapshot_interval==0)
+	{
+		xcs_utility::error(class_name(), "constructor", "Test snapshot interval must be at least 1", 1);
+	}
+	if (flag_concurrent_test && batch_size>1)
+	{
+		xcs_utility::error(class_name(), "constructor", "Concurrent test problems are not available when problems are batched", 1);
+	}
 }
 
 void experiment_mgr::print_parameters(ostream& OUTPUT)
@@ -705,22 +1578,58 @@ void experiment_mgr::print_parameters(ostream& OUTPUT)
 	OUTPUT << "\t" << "save experiment state every = " << save_experiment_interval << endl;
 	OUTPUT << "\t" << "save problem execution trace = " << (flag_trace?"on":"off") << endl;
 	OUTPUT << "\t" << "test environment = " << (flag_test_environment?"on":"off") << endl;
+	OUTPUT << "\t" << "parallel test environment = " << (flag_parallel_test_environment?"on":"off") << endl;
 	OUTPUT << "\t" << "maximum number of steps = " << no_max_steps << endl;
 	OUTPUT << "\t" << "teletransportation interval = " << teletransportation_interval << endl;
 	OUTPUT << "\t" << "save execution time report = " << (flag_save_time_report?"on":"off") << endl;
+	OUTPUT << "\t" << "save population statistics = " << (flag_population_statistics?"on":"off") << endl;
+	OUTPUT << "\t" << "save event trace = " << (flag_event_trace?"on":"off") << endl;
+	OUTPUT << "\t" << "event trace step interval = " << event_trace_step_interval << endl;
+	OUTPUT << "\t" << "live metrics = " << (flag_live_metrics?"on":"off") << endl;
+	OUTPUT << "\t" << "record interaction stream = " << (flag_record_stream?"on":"off") << endl;
 	OUTPUT << "\t" << "save action-value function = " << (flag_save_avf?"on":"off") << endl;
+	OUTPUT << "\t" << "freeze population = " << (flag_freeze_population?"on":"off") << endl;
+	OUTPUT << "\t" << "verify frozen population = " << (flag_verify_frozen_population?"on":"off") << endl;
+	OUTPUT << "\t" << "action-value function format = " << (flag_binary_avf?"binary":"text") << endl;
+	OUTPUT << "\t" << "number of threads = " << no_threads << endl;
+	OUTPUT << "\t" << "concurrent test problems = " << (flag_concurrent_test?"on":"off") << endl;
+	OUTPUT << "\t" << "test snapshot interval = " << test_snapshot_interval << endl;
+	OUTPUT << "\t" << "batch size = " << batch_size << endl;
 	OUTPUT << "</" << tag_name() << ">" << endl;
 }
 
+//! the random numbers drawn by the environment are recorded, thus the replay can skip them
+void
+experiment_mgr::begin_environment_problem(const bool exploration)
+{
+	unsigned long long	draws = xcs_random::draws();
+
+	environment->begin_problem(exploration);
+
+	if (stream.is_open())
+		stream.begin_problem(exploration, xcs_random::draws()-draws, environment->state().string_value());
+}
+
+/*!
+ * The states are collected and [P] is copied (or frozen) on the calling thread; then a background
+ * thread evaluates the states in parallel chunks and writes the file, so that the next experiment
+ * can start meanwhile. Only one action-value function is written at a time.
+ *
+ * The text format (avf.<ext>-<exp>.gz) has the header State|a1|a2|... and one line for each state.
+ * The binary format (avf.<ext>-<exp>.bin) starts with the string XCSAVF01, the number of inputs, of
+ * actions (both 32 bits), and of states (64 bits), and the label of each action (32 bit length
+ * followed by the characters); then, for each state, the inputs packed 8 per byte (the first input
+ * is the most significant bit) followed by one double for each action, NaN when no classifier
+ * matches. Numbers are saved in the byte order of the machine.
+ */
 void 
-experiment_mgr::save_avf(const unsigned long expNo, const unsigned long problem_no) const
+experiment_mgr::save_avf(const unsigned long expNo, const unsigned long problem_no)
 {
 	char filename[MSGSTR];
-	char system_command[MSGSTR];
-
-	ofstream AVF;
 	t_action action;
 
+	wait_avf();
+
 	if (problem_no==0)
 	{
 		clog << "\t" << current_experiment+1 << "/" << first_experiment+no_experiments << "\t";
@@ -734,38 +1643,267 @@ experiment_mgr::save_avf(const unsigned long expNo, const unsigned long problem_
 	else 
 		snprintf(filename, MSGSTR, "avf.%s-%04d-%015ld", extension.c_str(), (int) current_experiment, problem_no);
 
-	AVF.open(filename);
+	//! the states are collected first and then predicted all together without modifying [P]
+	vector<t_state>		states;
+	vector<string>		labels;
+
+	environment->reset_problem();
+
+	do {
+		states.push_back(environment->state());
+	} while (environment->next_problem());
 
-	if (!AVF.good())
+	for (unsigned long i=0; i<no_actions; i++)
 	{
-		xcs_utility::error(class_name(),"save_agent", "Population file " + string(filename) + " not open", 1);
+		ostringstream	label;
+
+		label << t_action(i);
+		labels.push_back(label.str());
+	}
+
+	t_predictor		predictor = population_predictor(states);
+
+	string			file_name(filename);
+	bool			flag_binary = flag_binary_avf;
+	unsigned long	threads = no_threads;
+	string			*error = &avf_error;
+
+	//! the writer does not stop the program, which is not safe from a thread other than the main one; its errors are reported by wait_avf
+	//! the states and the labels are moved into the writer, thus they are not kept twice while the file is written
+	avf_writer = std::thread([predictor, states = std::move(states), labels = std::move(labels), file_name, flag_binary, threads, no_actions, problem_no, error]() {
+		xcs_event_trace::span	trace_save("save action-value function", "io", "problem", problem_no);
+		vector<double>	prediction;
+		vector<bool>	matched;
+		unsigned long	no_unmatched = 0;
+
+		parallel_predict(predictor, no_actions, states, threads, prediction, matched);
+
+		for (unsigned long i=0; i<matched.size(); i++)
+		{
+			if (!matched[i])
+				no_unmatched++;
+		}
+
+		if (flag_binary)
+		{
+			string		binary_name = file_name + ".bin";
+			ofstream	AVF(binary_name.c_str(), ios::binary);
+
+			if (!AVF.good())
+			{
+				*error = "Action-value function file " + binary_name + " not open";
+				return;
+			}
+
+			uint32_t	no_inputs = states.empty() ? 0 : states[0].string_value().size();
+			uint32_t	actions = no_actions;
+			uint64_t	no_states = states.size();
+
+			AVF.write("XCSAVF01", 8);
+			AVF.write((const char*) &no_inputs, sizeof(no_inputs));
+			AVF.write((const char*) &actions, sizeof(actions));
+			AVF.write((const char*) &no_states, sizeof(no_states));
+			for (unsigned long i=0; i<labels.size(); i++)
+			{
+				uint32_t	length = labels[i].size();
+
+				AVF.write((const char*) &length, sizeof(length));
+				AVF.write(labels[i].c_str(), length);
+			}
+
+			vector<unsigned char>	packed((no_inputs+7)/8);
+
+			for (unsigned long s=0; s<states.size(); s++)
+			{
+				string	inputs = states[s].string_value();
+
+				fill(packed.begin(), packed.end(), 0);
+				for (unsigned long bit=0; bit<no_inputs; bit++)
+				{
+					if (inputs[bit]=='1')
+						packed[bit/8] |= (0x80 >> (bit%8));
+				}
+				AVF.write((const char*) packed.data(), packed.size());
+
+				for (unsigned long i=0; i<no_actions; i++)
+				{
+					double	value = matched[s*no_actions+i] ? prediction[s*no_actions+i] : NAN;
+
+					AVF.write((const char*) &value, sizeof(value));
+				}
+			}
+			AVF.close();
+		} else {
+			ofstream	AVF(file_name.c_str());
+
+			if (!AVF.good())
+			{
+				*error = "Action-value function file " + file_name + " not open";
+				return;
+			}
+
+			//! column names
+			AVF << "State";
+			for (unsigned long i=0; i<no_actions; i++)
+			{
+				AVF << "|"<< labels[i];
+			}
+			AVF << endl;
+
+			for (unsigned long s=0; s<states.size(); s++)
+			{
+				AVF << states[s];
+				for (unsigned long i=0; i<no_actions; i++)
+				{
+					AVF << "|"<< prediction[s*no_actions+i];
+				}
+				AVF << endl;
+			}
+			AVF.close();
+
+			char system_command[MSGSTR];
+
+			snprintf(system_command, MSGSTR, "gzip -f %s", file_name.c_str());
+			system(system_command);
+		}
+
+		if (no_unmatched>0)
+		{
+			clog << "\tWARNING: " << no_unmatched << " state-action pairs of " << file_name << " are not matched by [P], their prediction is saved as " << (flag_binary ? "NaN" : "0") << endl;
+		}
+	});
+
+	if (problem_no==0)
+		clog << "\tok (written in background)" << endl;
+}
+
+experiment_mgr::~experiment_mgr()
+{
+	if (avf_writer.joinable())
+		avf_writer.join();
+
+	if (!avf_error.empty())
+	{
+		xcs_utility::warning(class_name(), "destructor", avf_error);
 	}
+}
+
+void
+experiment_mgr::wait_avf()
+{
+	if (avf_writer.joinable())
+		avf_writer.join();
 
-	//! column names
-	AVF << "State";
-	for (int i=0; i<no_actions;i++)
+	if (!avf_error.empty())
 	{
-		AVF << "|"<< t_action(i);
+		xcs_utility::error(class_name(), "save_avf", avf_error, 1);
 	}
-	AVF << endl;
+}
 
-	environment->reset_problem();
+experiment_mgr::t_predictor
+experiment_mgr::population_predictor(const vector<t_state>& states) const
+{
+	//! an empty [P], or one whose diagram is too large, is scanned through a snapshot as when it is not frozen
+	if (flag_freeze_population)
+	{
+		shared_ptr<frozen_population>	frozen(new frozen_population());
 
-	do {
-		vector<double> prediction = xcs->predict(environment->state());
-		AVF << environment->state();
-		for (int i=0; i<no_actions;i++)
+		if (xcs->freeze(*frozen))
 		{
-			AVF << "|"<< prediction[i];
+			//! the check scans [P] for each state, thus it is performed only when required
+			if (flag_verify_frozen_population && (xcs->compare(*frozen, states)!=0))
+			{
+				xcs_utility::error(class_name(), "population_predictor", "the frozen population is not equivalent to [P]", 1);
+			}
+			return [frozen](const vector<t_state>& inputs, vector<double>& prediction, vector<bool>& matched) { frozen->predict(inputs, prediction, matched); };
 		}
-		AVF << endl;
-	} while (environment->next_problem());
-	AVF.close();
-	
-	snprintf(system_command, MSGSTR, "gzip -f %s", filename);
-	system(system_command);
 
-	if (problem_no==0)
-		clog << "\tok" << endl;
+		if (xcs->size()>0)
+		{
+			xcs_utility::warning(class_name(), "population_predictor", "[P] is too large to be frozen, a snapshot is used instead");
+		}
+	}
+
+	xcs_event_trace::span			trace_snapshot("snapshot", "snapshot");
+	shared_ptr<population_snapshot>	snapshot(new population_snapshot());
+
+	xcs->snapshot(*snapshot);
+	return [snapshot](const vector<t_state>& inputs, vector<double>& prediction, vector<bool>& matched) { snapshot->predict(inputs, prediction, matched); };
+}
+
+/*!
+ * as in xcs_classifier_system::select_best_action, the scan starts from a random action and the
+ * last action with the highest prediction is selected
+ */
+unsigned long
+experiment_mgr::greedy_action(const vector<double>& prediction, const vector<bool>& matched, const unsigned long no_actions)
+{
+	static thread_local vector<unsigned long>	available_actions;
+
+	available_actions.clear();
+	for(unsigned long act=0; act<no_actions; act++)
+	{
+		if (matched[act])
+			available_actions.push_back(act);
+	}
+
+	if (available_actions.empty())
+		return xcs_random::dice(no_actions);
+
+	unsigned long	random_index = xcs_random::dice(available_actions.size());
+	unsigned long	best_index = random_index;
+
+	for(unsigned long i=1; i<available_actions.size(); i++)
+	{
+		unsigned long	next_index = (random_index+i)%available_actions.size();
+
+		if (prediction[available_actions[best_index]]<=prediction[available_actions[next_index]])
+			best_index = next_index;
+	}
+	return available_actions[best_index];
+}
+
+/*!
+ * the chunks are assigned dynamically to the threads; each chunk has its own outputs, which are
+ * merged in the order of the states once all the threads end
+ */
+void
+experiment_mgr::parallel_predict(const t_predictor& predictor, const unsigned long no_actions, const vector<t_state>& states, const unsigned long no_threads, vector<double>& prediction, vector<bool>& matched)
+{
+	const unsigned long		chunk_size = 256;
+	unsigned long			no_chunks = (states.size()+chunk_size-1)/chunk_size;
+
+	vector< vector<double> >	chunk_prediction(no_chunks);
+	vector< vector<bool> >		chunk_matched(no_chunks);
+	atomic<unsigned long>		next_chunk(0);
+	vector<std::thread>			pool;
+
+	for (unsigned long t=0; t<min(no_threads, no_chunks); t++)
+	{
+		pool.push_back(std::thread([&]() {
+			vector<t_state>	chunk;
+
+			for (unsigned long c=next_chunk++; c<no_chunks; c=next_chunk++)
+			{
+				chunk.assign(states.begin()+c*chunk_size, states.begin()+min(states.size(), (c+1)*chunk_size));
+				predictor(chunk, chunk_prediction[c], chunk_matched[c]);
+			}
+		}));
+	}
+
+	for (unsigned long t=0; t<pool.size(); t++)
+	{
+		pool[t].join();
+	}
+
+	prediction.clear();
+	matched.clear();
+	prediction.reserve(states.size()*no_actions);
+	matched.reserve(states.size()*no_actions);
+	for (unsigned long c=0; c<no_chunks; c++)
+	{
+		prediction.insert(prediction.end(), chunk_prediction[c].begin(), chunk_prediction[c].end());
+		matched.insert(matched.end(), chunk_matched[c].begin(), chunk_matched[c].end());
+	}
 }
 
@@ -0,0 +1,422 @@
+/*!
+ * \file logic_minimizer.cpp
+ *
+ * \brief implements the two-level logic minimization of ternary covers
+ *
+ */
+
+#include <algorithm>
+#include "xcs_utility.h"
+#include "logic_minimizer.h"
+
+logic_minimizer::logic_minimizer(const unsigned long no_inputs)
+{
+	if ((no_inputs==0) || (no_inputs>64))
+	{
+		xcs_utility::error(class_name(), "constructor", "the number of inputs must be between 1 and 64", 1);
+	}
+
+	this->no_inputs = no_inputs;
+}
+
+logic_minimizer::t_cube
+logic_minimizer::cube(const string& condition) const
+{
+	t_cube	cube = {0, 0};
+
+	if (condition.size()!=no_inputs)
+	{
+		xcs_utility::error(class_name(), "cube", "condition '" + condition + "' has the wrong size", 1);
+	}
+
+	for(unsigned long i=0; i<no_inputs; i++)
+	{
+		switch (condition[i])
+		{
+			case '0':
+				cube.care |= input_bit(i);
+				break;
+			case '1':
+				cube.care |= input_bit(i);
+				cube.value |= input_bit(i);
+				break;
+			case '#':
+			case '-':
+			case '2':
+				break;
+			default:
+				xcs_utility::error(class_name(), "cube", "symbol not allowed in condition '" + condition + "'", 1);
+		}
+	}
+	return cube;
+}
+
+string
+logic_minimizer::cube_string(const t_cube& cube, const char dont_care) const
+{
+	string	condition(no_inputs, dont_care);
+
+	for(unsigned long i=0; i<no_inputs; i++)
+	{
+		if (cube.care & input_bit(i))
+		{
+			condition[i] = (cube.value & input_bit(i)) ? '1' : '0';
+		}
+	}
+	return condition;
+}
+
+void
+logic_minimizer::minimize(const vector<t_cube>& on_set, const vector<t_cube>& off_set, vector<t_cube>& cover) const
+{
+	vector<t_cube>	best;				//! smallest cover found so far
+
+	for(vector<t_cube>::const_iterator on=on_set.begin(); on!=on_set.end(); on++)
+	{
+		for(vector<t_cube>::const_iterator off=off_set.begin(); off!=off_set.end(); off++)
+		{
+			if (intersects(*on, *off))
+			{
+				xcs_utility::error(class_name(), "minimize", "ON-set and OFF-set intersect in '" + cube_string(*on) + "'", 1);
+			}
+		}
+	}
+
+	//! the ON-set is the initial cover
+	cover = on_set;
+	sort(cover.begin(), cover.end());
+	cover.erase(unique(cover.begin(), cover.end()), cover.end());
+
+	if (cover.empty())
+		return;
+
+	for(unsigned long iteration=0; iteration<max_iterations; iteration++)
+	{
+		expand(cover, on_set, off_set);
+		irredundant(cover, on_set);
+
+		if ((iteration>0) && (cover.size()>=best.size()))
+			break;
+
+		best = cover;
+		reduce(cover, on_set);
+	}
+
+	cover = best;
+	sort(cover.begin(), cover.end());
+}
+
+void
+logic_minimizer::minimize(const vector< vector<t_cube> >& partition, const vector<t_cube>& off_set, vector< vector<t_cube> >& covers) const
+{
+	covers.assign(partition.size(), vector<t_cube>());
+
+	for(unsigned long element=0; element<partition.size(); element++)
+	{
+		vector<t_cube>	element_off_set(off_set);
+
+		for(unsigned long other=0; other<partition.size(); other++)
+		{
+			if (other!=element)
+			{
+				element_off_set.insert(element_off_set.end(), partition[other].begin(), partition[other].end());
+			}
+		}
+
+		minimize(partition[element], element_off_set, covers[element]);
+	}
+}
+
+/*!
+ * the most specific cubes are expanded first, since they are the least likely to be
+ * covered by the expansion of other cubes (as in espresso)
+ */
+void
+logic_minimizer::expand(vector<t_cube>& cover, const vector<t_cube>& on_set, const vector<t_cube>& off_set) const
+{
+	vector<t_cube>	expanded;
+	vector<bool>	covered(on_set.size(), false);	//! true if the cube in the ON-set is covered by an expanded cube
+
+	stable_sort(cover.begin(), cover.end(),
+		[](const t_cube& first, const t_cube& second) { return __builtin_popcountll(first.care)>__builtin_popcountll(second.care); });
+
+	for(vector<t_cube>::iterator cube=cover.begin(); cube!=cover.end(); cube++)
+	{
+		bool	contained = false;
+
+		for(vector<t_cube>::const_iterator prime=expanded.begin(); (!contained) && (prime!=expanded.end()); prime++)
+		{
+			contained = contains(*prime, *cube);
+		}
+
+		if (contained)
+			continue;
+
+		expand_cube(*cube, on_set, covered, off_set);
+		expanded.push_back(*cube);
+
+		for(unsigned long on=0; on<on_set.size(); on++)
+		{
+			if (!covered[on] && contains(*cube, on_set[on]))
+			{
+				covered[on] = true;
+			}
+		}
+	}
+
+	cover.swap(expanded);
+}
+
+/*!
+ * The expansion works in two phases. First, the cube is merged with the uncovered ON cubes
+ * that are feasibly covered, i.e., whose supercube with the cube does not intersect the OFF-set;
+ * each time the ON cube whose supercube contains the largest number of uncovered ON cubes is chosen.
+ * Then, the remaining literals are raised one by one: a literal can be raised when no cube of the
+ * OFF-set is at distance one from the cube along that literal; among them, the one that brings the
+ * largest number of uncovered ON cubes inside the cube is chosen, and ties are broken by choosing
+ * the literal that blocks the smallest number of future expansions, i.e., the one with fewest
+ * OFF cubes at distance two along it. The cube is expanded until no literal can be raised,
+ * thus the result is a prime implicant.
+ */
+void
+logic_minimizer::expand_cube(t_cube& cube, const vector<t_cube>& on_set, const vector<bool>& covered, const vector<t_cube>& off_set) const
+{
+	vector<unsigned long>	gain(no_inputs);
+	vector<unsigned long>	blocking(no_inputs);
+
+	while (true)
+	{
+		t_cube			best_supercube = cube;
+		unsigned long	best_count = 0;
+
+		for(unsigned long on=0; on<on_set.size(); on++)
+		{
+			if (covered[on] || contains(cube, on_set[on]))
+				continue;
+
+			t_cube	supercube = merge(cube, on_set[on]);
+			bool	feasible = true;
+
+			for(vector<t_cube>::const_iterator off=off_set.begin(); feasible && (off!=off_set.end()); off++)
+			{
+				feasible = !intersects(supercube, *off);
+			}
+
+			if (!feasible)
+				continue;
+
+			unsigned long	count = 0;
+
+			for(unsigned long other=0; other<on_set.size(); other++)
+			{
+				if (!covered[other] && contains(supercube, on_set[other]))
+					count++;
+			}
+
+			if (count>best_count)
+			{
+				best_count = count;
+				best_supercube = supercube;
+			}
+		}
+
+		if (best_count==0)
+			break;
+
+		cube = best_supercube;
+	}
+
+	while (true)
+	{
+		uint64_t	blocked = 0;		//! literals that cannot be raised
+
+		fill(blocking.begin(), blocking.end(), 0);
+
+		for(vector<t_cube>::const_iterator off=off_set.begin(); off!=off_set.end(); off++)
+		{
+			uint64_t	difference = (cube.value ^ off->value) & cube.care & off->care;
+			int			distance = __builtin_popcountll(difference);
+
+			if (distance==1)
+			{
+				blocked |= difference;
+			} else if (distance==2) {
+				for(unsigned long i=0; i<no_inputs; i++)
+				{
+					if (difference & input_bit(i))
+						blocking[i]++;
+				}
+			}
+		}
+
+		uint64_t	candidates = cube.care & ~blocked;
+
+		if (candidates==0)
+			break;
+
+		fill(gain.begin(), gain.end(), 0);
+
+		for(unsigned long on=0; on<on_set.size(); on++)
+		{
+			if (covered[on])
+				continue;
+
+			//! literals of the cube that prevent the ON cube from being contained
+			uint64_t	mismatch = (cube.care & ~on_set[on].care) | ((cube.value ^ on_set[on].value) & cube.care);
+
+			if ((mismatch!=0) && ((mismatch & (mismatch-1))==0) && (mismatch & candidates))
+			{
+				gain[no_inputs-1-__builtin_ctzll(mismatch)]++;
+			}
+		}
+
+		unsigned long	selected = no_inputs;
+
+		for(unsigned long i=0; i<no_inputs; i++)
+		{
+			if (!(candidates & input_bit(i)))
+				continue;
+
+			if ((selected==no_inputs) ||
+				(gain[i]>gain[selected]) ||
+				((gain[i]==gain[selected]) && (blocking[i]<blocking[selected])))
+			{
+				selected = i;
+			}
+		}
+
+		cube.care &= ~input_bit(selected);
+		cube.value &= cube.care;
+	}
+}
+
+/*!
+ * the cubes that are the only ones to cover some ON cube are essential; the ON cubes
+ * left uncovered by the essential cubes are then covered greedily, choosing each time the
+ * cube that covers most of them
+ */
+void
+logic_minimizer::irredundant(vector<t_cube>& cover, const vector<t_cube>& on_set) const
+{
+	vector< vector<unsigned long> >	covering(on_set.size());	//! cubes of the cover that contain each ON cube
+	vector<bool>					selected(cover.size(), false);
+	vector<bool>					covered(on_set.size(), false);
+	unsigned long					no_uncovered = on_set.size();
+
+	for(unsigned long on=0; on<on_set.size(); on++)
+	{
+		for(unsigned long c=0; c<cover.size(); c++)
+		{
+			if (contains(cover[c], on_set[on]))
+			{
+				covering[on].push_back(c);
+			}
+		}
+
+		if (covering[on].empty())
+		{
+			xcs_utility::error(class_name(), "irredundant", "cube '" + cube_string(on_set[on]) + "' of the ON-set is not covered", 1);
+		}
+
+		//! essential cubes
+		if (covering[on].size()==1)
+		{
+			selected[covering[on].front()] = true;
+		}
+	}
+
+	for(unsigned long on=0; on<on_set.size(); on++)
+	{
+		for(vector<unsigned long>::const_iterator c=covering[on].begin(); c!=covering[on].end(); c++)
+		{
+			if (selected[*c])
+			{
+				covered[on] = true;
+				no_uncovered--;
+				break;
+			}
+		}
+	}
+
+	while (no_uncovered>0)
+	{
+		vector<unsigned long>	count(cover.size(), 0);
+
+		for(unsigned long on=0; on<on_set.size(); on++)
+		{
+			if (covered[on])
+				continue;
+
+			for(vector<unsigned long>::const_iterator c=covering[on].begin(); c!=covering[on].end(); c++)
+			{
+				count[*c]++;
+			}
+		}
+
+		unsigned long best = max_element(count.begin(), count.end())-count.begin();
+		selected[best] = true;
+
+		for(unsigned long on=0; on<on_set.size(); on++)
+		{
+			if (!covered[on] && contains(cover[best], on_set[on]))
+			{
+				covered[on] = true;
+				no_uncovered--;
+			}
+		}
+	}
+
+	vector<t_cube>	irredundant_cover;
+
+	for(unsigned long c=0; c<cover.size(); c++)
+	{
+		if (selected[c])
+			irredundant_cover.push_back(cover[c]);
+	}
+
+	cover.swap(irredundant_cover);
+}
+
+void
+logic_minimizer::reduce(vector<t_cube>& cover, const vector<t_cube>& on_set) const
+{
+	for(unsigned long c=0; c<cover.size(); c++)
+	{
+		t_cube	supercube = {0, 0};
+		bool	empty = true;
+
+		for(vector<t_cube>::const_iterator on=on_set.begin(); on!=on_set.end(); on++)
+		{
+			if (!contains(cover[c], *on))
+				continue;
+
+			//! the ON cube is also covered by another cube of the current cover
+			bool	shared = false;
+
+			for(unsigned long other=0; (!shared) && (other<cover.size()); other++)
+			{
+				shared = (other!=c) && contains(cover[other], *on);
+			}
+
+			if (shared)
+				continue;
+
+			if (empty)
+			{
+				supercube = *on;
+				empty = false;
+			} else {
+				supercube = merge(supercube, *on);
+			}
+		}
+
+		//! the cube is replaced by the reduced one, so that the following cubes see the reduction
+		if (empty)
+		{
+			cover.erase(cover.begin()+c);
+			c--;
+		} else {
+			cover[c] = supercube;
+		}
+	}
+}
@@ -0,0 +1,194 @@
+/*!
+ * \file minimization_scheduler.cpp
+ *
+ * \brief implements the parallel minimization of independent functions
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <unistd.h>
+#include "xcs_utility.h"
+#include "minimization_scheduler.h"
+
+minimization_scheduler::minimization_scheduler(const unsigned long no_inputs, const unsigned long no_threads, const string& cache_directory) : logic(no_inputs)
+{
+	this->no_threads = (no_threads>0) ? no_threads : max(1U, thread::hardware_concurrency());
+	this->cache_directory = cache_directory;
+	no_cached = 0;
+}
+
+unsigned long
+minimization_scheduler::add(const vector<logic_minimizer::t_cube>& on_set, const vector<logic_minimizer::t_cube>& off_set)
+{
+	t_job	job;
+
+	job.on_set = on_set;
+	job.off_set = off_set;
+	job.cached = false;
+	jobs.push_back(job);
+
+	return jobs.size()-1;
+}
+
+/*!
+ * each thread repeatedly takes the index of the next job from a shared counter; the jobs
+ * are independent and the minimizer is not modified, thus no other synchronization is needed
+ */
+void
+minimization_scheduler::run()
+{
+	atomic<unsigned long>	next(0);
+	vector<thread>			pool;
+	unsigned long			size = min(no_threads, (unsigned long) jobs.size());
+
+	for(unsigned long t=0; t<size; t++)
+	{
+		pool.push_back(thread([this, &next]() {
+			for(unsigned long job=next++; job<jobs.size(); job=next++)
+			{
+				minimize(jobs[job]);
+			}
+		}));
+	}
+
+	for(vector<thread>::iterator t=pool.begin(); t!=pool.end(); t++)
+	{
+		t->join();
+	}
+
+	no_cached = count_if(jobs.begin(), jobs.end(), [](const t_job& job) { return job.cached; });
+}
+
+void
+minimization_scheduler::minimize(t_job& job) const
+{
+	if ((cache_directory!="") && load(job))
+	{
+		job.cached = true;
+		return;
+	}
+
+	logic.minimize(job.on_set, job.off_set, job.cover);
+
+	if (cache_directory!="")
+	{
+		save(job);
+	}
+}
+
+/*!
+ * FNV-1a over the sorted ON-set, a separator, and the sorted OFF-set; the cubes are sorted
+ * so that the hash does not depend on the order of the rows in the table
+ */
+uint64_t
+minimization_scheduler::hash(const vector<logic_minimizer::t_cube>& on_set, const vector<logic_minimizer::t_cube>& off_set)
+{
+	uint64_t	value = 14695981039346656037ULL;
+
+	auto mix = [&value](uint64_t word) {
+		for(unsigned long byte=0; byte<8; byte++)
+		{
+			value ^= (word >> (8*byte)) & 0xff;
+			value *= 1099511628211ULL;
+		}
+	};
+
+	vector<logic_minimizer::t_cube>	on(on_set);
+	vector<logic_minimizer::t_cube>	off(off_set);
+
+	sort(on.begin(), on.end());
+	sort(off.begin(), off.end());
+
+	for(vector<logic_minimizer::t_cube>::const_iterator cube=on.begin(); cube!=on.end(); cube++)
+	{
+		mix(cube->care);
+		mix(cube->value);
+	}
+
+	mix(~0ULL);
+
+	for(vector<logic_minimizer::t_cube>::const_iterator cube=off.begin(); cube!=off.end(); cube++)
+	{
+		mix(cube->care);
+		mix(cube->value);
+	}
+
+	return value;
+}
+
+string
+minimization_scheduler::cache_file(const t_job& job) const
+{
+	ostringstream	name;
+
+	name << cache_directory << "/" << setfill('0') << setw(16) << hex << hash(job.on_set, job.off_set) << ".cover";
+	return name.str();
+}
+
+/*!
+ * the cache file contains the number of inputs, the sizes of the ON-set and of the OFF-set,
+ * the number of cubes, and then the cubes of the cover, one for each line
+ */
+bool
+minimization_scheduler::load(t_job& job) const
+{
+	ifstream		CACHE(cache_file(job).c_str());
+	unsigned long	no_inputs, no_on, no_off, no_cubes;
+
+	if (!(CACHE >> no_inputs >> no_on >> no_off >> no_cubes))
+		return false;
+
+	if ((no_inputs!=logic.inputs()) || (no_on!=job.on_set.size()) || (no_off!=job.off_set.size()))
+		return false;
+
+	vector<logic_minimizer::t_cube>	cover;
+	string							condition;
+
+	for(unsigned long c=0; c<no_cubes; c++)
+	{
+		if (!(CACHE >> condition) || (condition.size()!=no_inputs))
+			return false;
+		cover.push_back(logic.cube(condition));
+	}
+
+	job.cover.swap(cover);
+	return true;
+}
+
+/*!
+ * the cover is written to a temporary file which is then renamed, thus concurrent runs
+ * sharing the same cache never read a partial file
+ */
+void
+minimization_scheduler::save(const t_job& job) const
+{
+	string	file_name = cache_file(job);
+	ostringstream	temporary_name;
+
+	temporary_name << file_name << "." << getpid() << "." << this_thread::get_id();
+
+	ofstream	CACHE(temporary_name.str().c_str());
+
+	if (!CACHE.good())
+	{
+		xcs_utility::error(class_name(), "save", "cache file '" + temporary_name.str() + "' not open", 1);
+	}
+
+	CACHE << logic.inputs() << " " << job.on_set.size() << " " << job.off_set.size() << " " << job.cover.size() << endl;
+	for(vector<logic_minimizer::t_cube>::const_iterator cube=job.cover.begin(); cube!=job.cover.end(); cube++)
+	{
+		CACHE << logic.cube_string(*cube) << endl;
+	}
+	CACHE.close();
+
+	if (rename(temporary_name.str().c_str(), file_name.c_str())!=0)
+	{
+		xcs_utility::error(class_name(), "save", "cache file '" + file_name + "' not written", 1);
+	}
+}
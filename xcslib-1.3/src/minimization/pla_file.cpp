@@ -0,0 +1,149 @@
+/*!
+ * \file pla_file.cpp
+ *
+ * \brief implements the reading and writing of truth tables in the PLA format
+ *
+ */
+
+#include <sstream>
+#include <cstdlib>
+#include "xcs_utility.h"
+#include "pla_file.h"
+
+void
+pla_file::read(istream& input)
+{
+	string	line;
+
+	inputs.clear();
+	outputs.clear();
+	output_labels.clear();
+	input_labels = "";
+
+	while (getline(input, line))
+	{
+		istringstream	LINE(line);
+		string			keyword;
+
+		if (!(LINE >> keyword))
+			continue;
+
+		if (keyword[0]=='#')
+			continue;
+
+		if (keyword==".i")
+		{
+			LINE >> no_inputs;
+		} else if (keyword==".o") {
+			LINE >> no_outputs;
+		} else if (keyword==".ilb") {
+			getline(LINE, input_labels);
+		} else if (keyword==".olb") {
+			string label;
+			while (LINE >> label)
+				output_labels.push_back(label);
+		} else if (keyword==".e" || keyword==".end") {
+			break;
+		} else if (keyword[0]=='.') {
+			//! other directives (e.g., .p and .type) are not needed
+			continue;
+		} else {
+			string	output;
+
+			LINE >> output;
+			if ((keyword.size()!=no_inputs) || (output.size()!=no_outputs))
+			{
+				xcs_utility::error(class_name(), "read", "row '" + line + "' does not match the declared sizes", 1);
+			}
+			add(keyword, output);
+		}
+	}
+
+	if ((no_inputs==0) || (no_outputs==0))
+	{
+		xcs_utility::error(class_name(), "read", "number of inputs or outputs not declared", 1);
+	}
+}
+
+void
+pla_file::write(ostream& output) const
+{
+	output << ".i " << no_inputs << endl;
+	output << ".o " << no_outputs << endl;
+
+	if (input_labels!="")
+	{
+		output << ".ilb" << input_labels << endl;
+	}
+
+	if (output_labels.size()>0)
+	{
+		output << ".olb";
+		for(vector<string>::const_iterator label=output_labels.begin(); label!=output_labels.end(); label++)
+		{
+			output << " " << *label;
+		}
+		output << endl;
+	}
+
+	output << ".p " << inputs.size() << endl;
+	for(unsigned long row=0; row<inputs.size(); row++)
+	{
+		output << inputs[row] << " " << outputs[row] << endl;
+	}
+	output << ".e" << endl;
+}
+
+void
+pla_file::sets(const logic_minimizer& minimizer, const unsigned long output, vector<logic_minimizer::t_cube>& on_set, vector<logic_minimizer::t_cube>& off_set) const
+{
+	on_set.clear();
+	off_set.clear();
+
+	for(unsigned long row=0; row<inputs.size(); row++)
+	{
+		if (outputs[row][output]=='1')
+		{
+			on_set.push_back(minimizer.cube(inputs[row]));
+		} else if (outputs[row][output]=='0') {
+			off_set.push_back(minimizer.cube(inputs[row]));
+		}
+	}
+}
+
+void
+pla_file::set_covers(const logic_minimizer& minimizer, const vector< vector<logic_minimizer::t_cube> >& covers)
+{
+	inputs.clear();
+	outputs.clear();
+
+	for(unsigned long output=0; output<covers.size(); output++)
+	{
+		string	output_part(no_outputs, '0');
+
+		output_part[output] = '1';
+		for(vector<logic_minimizer::t_cube>::const_iterator cube=covers[output].begin(); cube!=covers[output].end(); cube++)
+		{
+			add(minimizer.cube_string(*cube, '-'), output_part);
+		}
+	}
+}
+
+double
+pla_file::payoff(const unsigned long output) const
+{
+	if (output>=output_labels.size())
+	{
+		xcs_utility::error(class_name(), "payoff", "output labels not available", 1);
+	}
+
+	string				label = output_labels[output];
+	string::size_type	start = label.find_first_of("-0123456789.");
+
+	if (start==string::npos)
+	{
+		xcs_utility::error(class_name(), "payoff", "output label '" + label + "' does not contain a payoff", 1);
+	}
+
+	return atof(label.substr(start).c_str());
+}
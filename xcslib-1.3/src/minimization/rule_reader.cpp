@@ -0,0 +1,271 @@
+/*!
+ * \file rule_reader.cpp
+ *
+ * \brief implements the reading of (condition, action, payoff) triples
+ *
+ */
+
+#include <cstdlib>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "xcs_utility.h"
+#include "rule_reader.h"
+
+rule_reader::rule_reader(const string& file_name)
+{
+	this->file_name = file_name;
+	compressed = (file_name.size()>3) && (file_name.substr(file_name.size()-3)==".gz");
+	decompressor = -1;
+
+	if (compressed)
+		input = open_decompressed();
+	else
+		input = fopen(file_name.c_str(), "r");
+
+	if (input==NULL)
+	{
+		xcs_utility::error(class_name(), "constructor", "file '" + file_name + "' not open", 1);
+	}
+
+	avf = false;
+	binary = false;
+	current = 0;
+
+	//! binary action-value functions start with a signature, otherwise the bytes read belong to the first line
+	char	signature[8];
+	size_t	size = fread(signature, 1, sizeof(signature), input);
+
+	if ((size==sizeof(signature)) && (string(signature, size)=="XCSAVF01"))
+	{
+		read_binary_header();
+	} else {
+		pending = string(signature, size);
+	}
+}
+
+rule_reader::~rule_reader()
+{
+	fclose(input);
+	if (decompressor>0)
+	{
+		int	status;
+
+		waitpid(decompressor, &status, 0);
+	}
+}
+
+/*!
+ * gzip receives the file name as an argument of exec, thus names with quotes or other characters
+ * of the shell are safe; a file that gzip cannot read gives an empty input, as with popen
+ */
+FILE*
+rule_reader::open_decompressed()
+{
+	int		channel[2];
+
+	if (access(file_name.c_str(), R_OK)!=0)
+		return NULL;
+
+	if (pipe(channel)==-1)
+		return NULL;
+
+	decompressor = fork();
+	if (decompressor==-1)
+	{
+		close(channel[0]);
+		close(channel[1]);
+		return NULL;
+	}
+
+	if (decompressor==0)
+	{
+		dup2(channel[1], STDOUT_FILENO);
+		close(channel[0]);
+		close(channel[1]);
+		execlp("gzip", "gzip", "-dc", "--", file_name.c_str(), (char*) NULL);
+		_exit(127);
+	}
+
+	close(channel[1]);
+	return fdopen(channel[0], "r");
+}
+
+bool
+rule_reader::next(string& condition, string& action, double& payoff)
+{
+	//! the values of an action-value function row are returned one action at a time
+	while (current>=values.size())
+	{
+		if (binary)
+		{
+			if (!read_binary_state())
+				return false;
+			current = 0;
+			continue;
+		}
+
+		if (!read_line())
+			return false;
+
+		if (line.empty())
+			continue;
+
+		if (line.compare(0, 5, "State")==0)
+		{
+			split(line, '|', actions);
+			actions.erase(actions.begin());
+			avf = true;
+			continue;
+		}
+
+		if (avf)
+		{
+			split(line, '|', values);
+			state = values[0];
+			values.erase(values.begin());
+			if (values.size()!=actions.size())
+			{
+				xcs_utility::error(class_name(), "next", "row '" + line + "' does not match the header", 1);
+			}
+		} else {
+			istringstream	LINE(line);
+			vector<string>	fields;
+			string			field;
+
+			while (LINE >> field)
+				fields.push_back(field);
+
+			//! populations start with the classifier id
+			unsigned long	first = (fields.size()>3) ? 1 : 0;
+
+			if (fields.size()<3)
+			{
+				xcs_utility::error(class_name(), "next", "row '" + line + "' has less than three fields", 1);
+			}
+
+			condition = fields[first];
+			action = fields[first+1];
+			payoff = atof(fields[first+2].c_str());
+			return true;
+		}
+
+		current = 0;
+	}
+
+	condition = state;
+	action = binary ? binary_actions[current] : actions[current];
+	payoff = atof(values[current].c_str());
+	current++;
+	return true;
+}
+
+bool
+rule_reader::read_line()
+{
+	char	buffer[4096];
+
+	line = pending;
+	pending.clear();
+	if (line.find('\n')!=string::npos)
+	{
+		pending = line.substr(line.find('\n')+1);
+		line.erase(line.find('\n'));
+		return true;
+	}
+	while (fgets(buffer, sizeof(buffer), input)!=NULL)
+	{
+		line += buffer;
+		if (line[line.size()-1]=='\n')
+		{
+			line.erase(line.size()-1);
+			return true;
+		}
+	}
+	return !line.empty();
+}
+
+void
+rule_reader::read_binary_header()
+{
+	uint32_t	no_actions;
+
+	if ((fread(&no_inputs, sizeof(no_inputs), 1, input)!=1) || (fread(&no_actions, sizeof(no_actions), 1, input)!=1) || (fread(&no_states, sizeof(no_states), 1, input)!=1))
+	{
+		xcs_utility::error(class_name(), "read_binary_header", "file '" + file_name + "' is truncated", 1);
+	}
+
+	actions.clear();
+	for(uint32_t act=0; act<no_actions; act++)
+	{
+		uint32_t	length;
+
+		if (fread(&length, sizeof(length), 1, input)!=1)
+		{
+			xcs_utility::error(class_name(), "read_binary_header", "file '" + file_name + "' is truncated", 1);
+		}
+
+		string		label(length, ' ');
+
+		if ((length>0) && (fread(&label[0], 1, length, input)!=length))
+		{
+			xcs_utility::error(class_name(), "read_binary_header", "file '" + file_name + "' is truncated", 1);
+		}
+		actions.push_back(label);
+	}
+
+	avf = true;
+	binary = true;
+}
+
+bool
+rule_reader::read_binary_state()
+{
+	if (no_states==0)
+		return false;
+
+	vector<unsigned char>	packed((no_inputs+7)/8);
+	vector<double>			payoff(actions.size());
+
+	if ((fread(packed.data(), 1, packed.size(), input)!=packed.size()) || (fread(payoff.data(), sizeof(double), payoff.size(), input)!=payoff.size()))
+	{
+		xcs_utility::error(class_name(), "read_binary_state", "file '" + file_name + "' is truncated", 1);
+	}
+	no_states--;
+
+	state.assign(no_inputs, '0');
+	for(uint32_t bit=0; bit<no_inputs; bit++)
+	{
+		if (packed[bit/8] & (0x80 >> (bit%8)))
+			state[bit] = '1';
+	}
+
+	//! values are kept as strings as in the text format
+	values.clear();
+	binary_actions.clear();
+	for(unsigned long act=0; act<payoff.size(); act++)
+	{
+		if (!std::isnan(payoff[act]))
+		{
+			ostringstream	value;
+
+			value << setprecision(17) << payoff[act];
+			values.push_back(value.str());
+			binary_actions.push_back(actions[act]);
+		}
+	}
+	return true;
+}
+
+void
+rule_reader::split(const string& str, const char separator, vector<string>& fields)
+{
+	istringstream	STR(str);
+	string			field;
+
+	fields.clear();
+	while (getline(STR, field, separator))
+		fields.push_back(xcs_utility::trim(field));
+}
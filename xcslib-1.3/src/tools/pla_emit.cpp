@@ -0,0 +1,229 @@
+/*!
+ * \file pla_emit.cpp
+ *
+ * \brief writes the PLA tables of a population or of an action-value function, one for each action
+ *
+ * The input can be a population saved by XCS (id, condition, action, prediction, ...), a solution
+ * or optimal population (condition, action, payoff), or an action-value function saved with
+ * "save action-value function = on" (State|a1|a2|...); files ending with .gz are read through gzip.
+ *
+ * The payoffs are grouped in levels (i.e., payoffs that round to the same multiple of the resolution)
+ * and, as in the notebooks, the table of each action has one output for each level, labeled with the
+ * average payoff of the level. The input is read twice: the first pass collects the levels and the
+ * actions, the second one streams the rows to the tables; thus the memory used does not depend on
+ * the number of rows.
+ *
+ * By default each condition is expanded into the configurations it matches; with -c the conditions
+ * are written directly as cubes in the compressed notation of espresso (# becomes -).
+ */
+
+#include <unistd.h>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <algorithm>
+#include "xcs_utility.h"
+#include "rule_reader.h"
+
+//! maximum number of don't cares of a condition that is expanded into configurations
+const unsigned long max_expanded_dont_cares = 24;
+
+/*!
+ * \fn void write_row(ostream&, string&, unsigned long, const string&)
+ * \brief writes the configurations matched by condition, one for each row
+ *
+ * the don't cares are replaced recursively, starting from position, inside condition itself
+ */
+void
+write_row(ostream& output, string& condition, const unsigned long position, const string& output_part)
+{
+	string::size_type	dont_care = condition.find('#', position);
+
+	if (dont_care==string::npos)
+	{
+		output << condition << " " << output_part << "\n";
+		return;
+	}
+
+	condition[dont_care] = '0';
+	write_row(output, condition, dont_care+1, output_part);
+	condition[dont_care] = '1';
+	write_row(output, condition, dont_care+1, output_part);
+	condition[dont_care] = '#';
+}
+
+/*!
+ * \fn int main(int argc, char *argv[])
+ * \param argc number of arguments
+ * \param argv list of arguments
+ *
+ * writes one PLA table for each action of the input file
+ */
+int
+main(int argc, char *argv[])
+{
+	string	str_prefix = "";		//! prefix of the tables
+	double	resolution = 1;			//! width of the payoff levels
+	bool	flag_compressed = false;	//! true if the conditions are written as cubes
+	int		o;						//! current option
+
+	while ( (o = getopt(argc, argv, "o:r:c")) != -1 )
+	{
+		switch (o)
+		{
+			case 'o':
+				str_prefix = string(optarg);
+				break;
+			case 'r':
+				resolution = atof(optarg);
+				break;
+			case 'c':
+				flag_compressed = true;
+				break;
+			default:
+				xcs_utility::error("main","main","unrecognized option",1);
+		}
+	}
+
+	if (optind!=argc-1)
+	{
+		cerr << "USAGE:\t\t" << argv[0] << "\t" << "[-o <prefix>] [-r <resolution>] [-c] <file>" << endl;
+		cerr << "      \t\t\t\t" << "<file>       population, solution, or action-value function (also .gz)" << endl;
+		cerr << "      \t\t\t\t" << "-o           the table of action a is <prefix>_a<a>.pla (default <file> without .gz)" << endl;
+		cerr << "      \t\t\t\t" << "-r           width of the payoff levels (default 1)" << endl;
+		cerr << "      \t\t\t\t" << "-c           write the conditions as cubes instead of expanding them" << endl;
+		return 0;
+	}
+
+	string	str_input(argv[optind]);
+
+	if (resolution<=0)
+	{
+		xcs_utility::error("main", "main", "the resolution must be positive", 1);
+	}
+
+	if (str_prefix=="")
+	{
+		str_prefix = str_input;
+		if ((str_prefix.size()>3) && (str_prefix.substr(str_prefix.size()-3)==".gz"))
+			str_prefix.erase(str_prefix.size()-3);
+	}
+
+	string			condition;
+	string			action;
+	double			payoff;
+	unsigned long	no_inputs = 0;
+
+	map<long, double>			sum;		//! sum of the payoffs of each level
+	map<long, unsigned long>	count;		//! number of payoffs of each level
+	map<string, unsigned long>	rows;		//! number of rows of each action
+
+	//! first pass: payoff levels and actions
+	{
+		rule_reader	reader(str_input);
+
+		while (reader.next(condition, action, payoff))
+		{
+			if (no_inputs==0)
+				no_inputs = condition.size();
+
+			if (condition.size()!=no_inputs)
+			{
+				xcs_utility::error("main", "main", "condition '" + condition + "' has the wrong size", 1);
+			}
+
+			long	level = lround(payoff/resolution);
+
+			sum[level] += payoff;
+			count[level]++;
+			rows[action]++;
+		}
+	}
+
+	if (rows.empty())
+	{
+		xcs_utility::error("main", "main", "file '" + str_input + "' is empty", 1);
+	}
+
+	//! output of each level, the levels are listed by increasing payoff
+	map<long, unsigned long>	output_index;
+	string						labels = ".olb";
+	unsigned long				no_outputs = 0;
+
+	for(map<long, double>::const_iterator level=sum.begin(); level!=sum.end(); level++)
+	{
+		ostringstream	label;
+		double			average = level->second/count[level->first];
+
+		output_index[level->first] = no_outputs++;
+
+		if (resolution>=1)
+			label << " p" << lround(average);
+		else
+			label << " p" << average;
+		labels += label.str();
+	}
+
+	//! second pass: the rows are streamed to the table of their action
+	map<string, ofstream*>	tables;
+
+	for(map<string, unsigned long>::const_iterator act=rows.begin(); act!=rows.end(); act++)
+	{
+		string		file_name = str_prefix + "_a" + act->first + ".pla";
+		ofstream	*table = new ofstream(file_name.c_str());
+
+		if (!table->good())
+		{
+			xcs_utility::error("main", "main", "table '" + file_name + "' not open", 1);
+		}
+
+		*table << ".i " << no_inputs << endl;
+		*table << ".o " << sum.size() << endl;
+		*table << labels << endl;
+		tables[act->first] = table;
+	}
+
+	{
+		rule_reader	reader(str_input);
+		string		output_part(sum.size(), '0');
+
+		while (reader.next(condition, action, payoff))
+		{
+			unsigned long	index = output_index[lround(payoff/resolution)];
+
+			output_part[index] = '1';
+
+			if (flag_compressed)
+			{
+				for(string::iterator symbol=condition.begin(); symbol!=condition.end(); symbol++)
+				{
+					if (*symbol=='#')
+						*symbol = '-';
+				}
+				*tables[action] << condition << " " << output_part << "\n";
+			} else {
+				if ((unsigned long) count_if(condition.begin(), condition.end(), [](char c) { return c=='#'; })>max_expanded_dont_cares)
+				{
+					xcs_utility::error("main", "main", "condition '" + condition + "' has too many don't cares, use -c", 1);
+				}
+				write_row(*tables[action], condition, 0, output_part);
+			}
+
+			output_part[index] = '0';
+		}
+	}
+
+	for(map<string, ofstream*>::iterator table=tables.begin(); table!=tables.end(); table++)
+	{
+		*table->second << ".e" << endl;
+		table->second->close();
+		delete table->second;
+	}
+
+	clog << tables.size() << " tables with " << sum.size() << " payoff levels written to " << str_prefix << "_a*.pla" << endl;
+
+	return 0;
+}
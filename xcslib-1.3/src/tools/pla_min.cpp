@@ -0,0 +1,169 @@
+/*!
+ * \file pla_min.cpp
+ *
+ * \brief minimizes a truth table in PLA format with the logic minimizer
+ *
+ * The table is read as in the espresso type fr: for each output, the rows with '1' are the
+ * ON-set, the rows with '0' are the OFF-set, and all the other configurations are don't cares.
+ * The result is written as a PLA table or, when an action is given, as a solution population
+ * with one condition, action, and payoff for each cube (the payoff is read from the output labels).
+ *
+ * Several tables (e.g., one for each action) can be minimized in the same run: every output of
+ * every table is an independent job executed by a pool of threads, and the minimized table of
+ * <file>.pla is written to <file>_minimized.pla. With a cache directory, the covers already
+ * computed in previous runs for the same ON-set and OFF-set are reused.
+ */
+
+#include <unistd.h>
+#include <fstream>
+#include <chrono>
+#include "xcs_utility.h"
+#include "logic_minimizer.h"
+#include "pla_file.h"
+#include "minimization_scheduler.h"
+
+int
+main(int argc, char *argv[])
+{
+	string			str_output = "";		//! output file, the standard output if empty
+	string			str_action = "";		//! action used to write the solution population
+	string			str_cache = "";			//! cache directory, no cache if empty
+	unsigned long	no_threads = 0;			//! number of threads, all the hardware threads if zero
+	int				o;						//! current option
+
+	while ( (o = getopt(argc, argv, "o:s:j:c:")) != -1 )
+	{
+		switch (o)
+		{
+			case 'o':
+				str_output = string(optarg);
+				break;
+			case 's':
+				str_action = string(optarg);
+				break;
+			case 'j':
+				no_threads = atol(optarg);
+				break;
+			case 'c':
+				str_cache = string(optarg);
+				break;
+			default:
+				xcs_utility::error("main","main","unrecognized option",1);
+		}
+	}
+
+	if (optind>=argc)
+	{
+		cerr << "USAGE:\t\t" << argv[0] << "\t" << "[-o <file>] [-s <action>] [-j <threads>] [-c <directory>] <file.pla> ..." << endl;
+		cerr << "      \t\t\t\t" << "-o           output file (default standard output)" << endl;
+		cerr << "      \t\t\t\t" << "-s           write the solution population for action <action>" << endl;
+		cerr << "      \t\t\t\t" << "-j           number of threads (default all the hardware threads)" << endl;
+		cerr << "      \t\t\t\t" << "-c           directory where the computed covers are cached" << endl;
+		cerr << "      \t\t\t\t" << "with more than one table, <file>.pla is minimized into <file>_minimized.pla" << endl;
+		return 0;
+	}
+
+	vector<string>		str_inputs(argv+optind, argv+argc);
+
+	if ((str_inputs.size()>1) && ((str_output!="") || (str_action!="")))
+	{
+		xcs_utility::error("main", "main", "options -o and -s require a single table", 1);
+	}
+
+	vector<pla_file>	tables(str_inputs.size());
+
+	for(unsigned long t=0; t<tables.size(); t++)
+	{
+		ifstream	INPUT(str_inputs[t].c_str());
+
+		if (!INPUT.good())
+		{
+			xcs_utility::error("main", "main", "PLA file '" + str_inputs[t] + "' not open", 1);
+		}
+
+		tables[t].read(INPUT);
+		INPUT.close();
+
+		if (tables[t].no_inputs!=tables[0].no_inputs)
+		{
+			xcs_utility::error("main", "main", "PLA file '" + str_inputs[t] + "' has a different number of inputs", 1);
+		}
+	}
+
+	minimization_scheduler		scheduler(tables[0].no_inputs, no_threads, str_cache);
+	const logic_minimizer&		minimizer = scheduler.minimizer();
+	vector< vector<unsigned long> >	jobs(tables.size());	//! job of each output of each table
+
+	for(unsigned long t=0; t<tables.size(); t++)
+	{
+		for(unsigned long output=0; output<tables[t].no_outputs; output++)
+		{
+			vector<logic_minimizer::t_cube>	on_set;
+			vector<logic_minimizer::t_cube>	off_set;
+
+			tables[t].sets(minimizer, output, on_set, off_set);
+			jobs[t].push_back(scheduler.add(on_set, off_set));
+		}
+	}
+
+	auto start = chrono::steady_clock::now();
+
+	scheduler.run();
+
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+
+	for(unsigned long t=0; t<tables.size(); t++)
+	{
+		vector< vector<logic_minimizer::t_cube> >	covers;
+		unsigned long								no_cubes = 0;
+		unsigned long								no_rows = tables[t].inputs.size();
+
+		for(unsigned long output=0; output<jobs[t].size(); output++)
+		{
+			covers.push_back(scheduler.cover(jobs[t][output]));
+			no_cubes += covers.back().size();
+		}
+
+		clog << str_inputs[t] << "\t" << no_rows << " rows\t" << no_cubes << " cubes" << endl;
+
+		string		str_file = str_output;
+
+		if (tables.size()>1)
+		{
+			string::size_type	extension = str_inputs[t].rfind(".pla");
+
+			str_file = str_inputs[t].substr(0, extension) + "_minimized.pla";
+		}
+
+		ofstream	OUTPUT;
+
+		if (str_file!="")
+		{
+			OUTPUT.open(str_file.c_str());
+			if (!OUTPUT.good())
+			{
+				xcs_utility::error("main", "main", "output file '" + str_file + "' not open", 1);
+			}
+		}
+
+		ostream&	output = (str_file!="") ? OUTPUT : cout;
+
+		if (str_action=="")
+		{
+			tables[t].set_covers(minimizer, covers);
+			tables[t].write(output);
+		} else {
+			for(unsigned long out=0; out<tables[t].no_outputs; out++)
+			{
+				for(vector<logic_minimizer::t_cube>::const_iterator cube=covers[out].begin(); cube!=covers[out].end(); cube++)
+				{
+					output << minimizer.cube_string(*cube) << "\t" << str_action << "\t" << tables[t].payoff(out) << endl;
+				}
+			}
+		}
+	}
+
+	clog << scheduler.size() << " functions (" << scheduler.cached() << " from the cache) minimized in " << elapsed << " s" << endl;
+
+	return 0;
+}
@@ -0,0 +1,365 @@
+/*!
+ * \file woods_verify.cpp
+ *
+ * \brief verifies that a population represents the optimal action-value function of a woods environment
+ *
+ * The environment is read from the configuration file used by XCS (i.e., confsys.<suffix>) and all
+ * its reachable states are enumerated with reset_problem() and next_problem(). For each state the
+ * prediction array of the population, computed as XCS does for the classifiers loaded with
+ * "initial population = solution:<file>", is compared with the optimal action values read from a
+ * Q-table (e.g., the one saved by woods-vi or the population learned by Q-learning) or from an
+ * action-value function file. Then, starting from each state, the greedy policy of the population
+ * is followed without slips and the number of steps needed to reach food is compared with the
+ * length of the shortest path. The states are checked in parallel.
+ */
+
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <map>
+#include "xcs_definitions.h"
+#include "xcs_utility.h"
+#include "rule_reader.h"
+
+//! a classifier of the population to be verified
+struct t_rule {
+	t_condition		condition;	//!< condition
+	unsigned long	action;		//!< action
+	double			payoff;		//!< prediction
+
+	t_rule() : action(0), payoff(0) {};
+
+	//! the condition is copied through its assignment operator, since conditions do not declare a copy constructor
+	t_rule(const t_rule& rule) : action(rule.action), payoff(rule.payoff) { condition = rule.condition; };
+
+	t_rule& operator=(const t_rule& rule) = default;
+};
+
+//! result of the verification of one state
+struct t_check {
+	vector<string>	errors;		//!< description of the mismatches found
+	bool			path;		//!< true if the greedy path from the state is optimal
+};
+
+/*!
+ * \fn void prediction_array(const vector<t_rule>&, const string&, vector<double>&, vector<bool>&)
+ * \brief computes the prediction array of the population in a state
+ *
+ * all the classifiers of a solution have the same fitness, thus the prediction of an action is the
+ * average prediction of the matching classifiers that advocate it
+ */
+void
+prediction_array(const vector<t_rule>& population, const string& state, vector<double>& prediction, vector<bool>& matched)
+{
+	vector<unsigned long>	count(prediction.size(), 0);
+
+	fill(prediction.begin(), prediction.end(), 0);
+
+	for(vector<t_rule>::const_iterator rule=population.begin(); rule!=population.end(); rule++)
+	{
+		if (rule->condition.match(state))
+		{
+			prediction[rule->action] += rule->payoff;
+			count[rule->action]++;
+		}
+	}
+
+	for(unsigned long act=0; act<prediction.size(); act++)
+	{
+		matched[act] = (count[act]>0);
+		if (matched[act])
+			prediction[act] /= count[act];
+	}
+}
+
+/*!
+ * \fn int main(int argc, char *argv[])
+ * \param argc number of arguments
+ * \param argv list of arguments
+ *
+ * verifies the population and returns 1 when it is not optimal
+ */
+int
+main(int argc, char *argv[])
+{
+	string			str_suffix = "";		//! configuration file suffix
+	string			str_population = "";	//! population to verify
+	string			str_qtable = "";		//! optimal action values
+	double			tolerance = 1;			//! maximum difference between predictions and optimal values
+	unsigned long	no_threads = 0;			//! number of threads, all the hardware threads if zero
+	unsigned long	max_reported = 10;		//! number of mismatching states reported
+	int				o;						//! current option
+
+	if (argc==1)
+	{
+		cerr << "USAGE:\t\t" << argv[0] << "\t" << "-f <suffix> -q <file> [-p <file>] [-t <tolerance>] [-j <threads>] [-m <states>]" << endl;
+		cerr << "      \t\t\t\t" << "<suffix>     suffix for the configuration file" << endl;
+		cerr << "      \t\t\t\t" << "-q           optimal Q-table or action-value function (also .gz)" << endl;
+		cerr << "      \t\t\t\t" << "-p           population to verify (default optimal_population.<suffix>-0000)" << endl;
+		cerr << "      \t\t\t\t" << "-t           maximum difference between predictions and optimal values (default 1)" << endl;
+		cerr << "      \t\t\t\t" << "-j           number of threads (default all the hardware threads)" << endl;
+		cerr << "      \t\t\t\t" << "-m           number of mismatching states reported (default 10)" << endl;
+		return 0;
+	}
+
+	while ( (o = getopt(argc, argv, "f:q:p:t:j:m:")) != -1 )
+	{
+		switch (o)
+		{
+			case 'f':
+				str_suffix = string(optarg);
+				break;
+			case 'q':
+				str_qtable = string(optarg);
+				break;
+			case 'p':
+				str_population = string(optarg);
+				break;
+			case 't':
+				tolerance = atof(optarg);
+				break;
+			case 'j':
+				no_threads = atol(optarg);
+				break;
+			case 'm':
+				max_reported = atol(optarg);
+				break;
+			default:
+				xcs_utility::error("main","main","unrecognized option",1);
+		}
+	}
+
+	if (str_qtable=="")
+	{
+		xcs_utility::error("main", "main", "the optimal Q-table must be specified with -q", 1);
+	}
+
+	if (str_population=="")
+	{
+		str_population = "optimal_population." + str_suffix + "-0000";
+	}
+
+	if (no_threads==0)
+	{
+		no_threads = max(1U, thread::hardware_concurrency());
+	}
+
+	//! init the configuration manager
+	xcs_configuration_manager	xcs_config(str_suffix);
+
+	//! init the condition class, the action class, and the environment
+	t_condition		dummy_condition(xcs_config);
+	t_action		dummy_action(xcs_config);
+	t_environment	environment(xcs_config);
+
+	unsigned long	no_moves = environment.moves();
+
+	if (no_moves!=dummy_action.actions())
+	{
+		xcs_utility::error("main", "main", "the number of actions does not match the number of moves", 1);
+	}
+
+	//! actions are read as strings and converted to their index
+	map<string, unsigned long>	action_index;
+
+	for(unsigned long act=0; act<no_moves; act++)
+	{
+		ostringstream	str_action;
+
+		str_action << t_action(act);
+		action_index[str_action.str()] = act;
+	}
+
+	string			condition;
+	string			action;
+	double			payoff;
+
+	//! population to verify
+	vector<t_rule>	population;
+	{
+		rule_reader	reader(str_population);
+
+		while (reader.next(condition, action, payoff))
+		{
+			if (action_index.find(action)==action_index.end())
+			{
+				xcs_utility::error("main", "main", "action '" + action + "' of the population is not valid", 1);
+			}
+
+			t_rule	rule;
+
+			rule.condition.set_string_value(condition);
+			rule.action = action_index[action];
+			rule.payoff = payoff;
+			population.push_back(rule);
+		}
+	}
+
+	//! optimal action values of each state
+	map<string, vector<double> >	qtable;
+	{
+		rule_reader	reader(str_qtable);
+
+		while (reader.next(condition, action, payoff))
+		{
+			if (action_index.find(action)==action_index.end())
+			{
+				xcs_utility::error("main", "main", "action '" + action + "' of the Q-table is not valid", 1);
+			}
+
+			vector<double>&	values = qtable[condition];
+
+			if (values.empty())
+				values.assign(no_moves, NAN);
+			values[action_index[action]] = payoff;
+		}
+	}
+
+	//! reachable states, position i is the i-th problem
+	vector<string>	states;
+
+	environment.reset_problem();
+	do
+	{
+		states.push_back(environment.state().string_value());
+	}
+	while (environment.next_problem());
+
+	//! length of the shortest path to food from each position
+	unsigned long			no_positions = environment.positions();
+	unsigned long			unreachable = no_positions;
+	vector<unsigned long>	distance(no_positions, unreachable);
+
+	for(unsigned long pos=states.size(); pos<no_positions; pos++)
+	{
+		distance[pos] = 0;
+	}
+
+	for(bool changed=true; changed; )
+	{
+		changed = false;
+		for(unsigned long pos=0; pos<states.size(); pos++)
+		{
+			for(unsigned long act=0; act<no_moves; act++)
+			{
+				unsigned long	next = environment.transition(pos, act);
+
+				if ((distance[next]!=unreachable) && (distance[next]+1<distance[pos]))
+				{
+					distance[pos] = distance[next]+1;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	auto start = chrono::steady_clock::now();
+
+	vector<t_check>			checks(states.size());
+	atomic<unsigned long>	next_state(0);
+	vector<thread>			pool;
+
+	for(unsigned long t=0; t<min(no_threads, (unsigned long) states.size()); t++)
+	{
+		pool.push_back(thread([&]() {
+			vector<double>	prediction(no_moves);
+			vector<bool>	matched(no_moves);
+
+			for(unsigned long pos=next_state++; pos<states.size(); pos=next_state++)
+			{
+				t_check&	check = checks[pos];
+				ostringstream	error;
+
+				//! prediction array vs optimal action values
+				prediction_array(population, states[pos], prediction, matched);
+
+				map<string, vector<double> >::const_iterator	q = qtable.find(states[pos]);
+
+				for(unsigned long act=0; act<no_moves; act++)
+				{
+					error.str("");
+					if (!matched[act])
+					{
+						error << "no classifier matches action " << t_action(act);
+					} else if ((q==qtable.end()) || std::isnan(q->second[act])) {
+						error << "action " << t_action(act) << " not in the Q-table";
+					} else if (fabs(prediction[act]-q->second[act])>tolerance) {
+						error << "action " << t_action(act) << " predicts " << prediction[act] << " instead of " << q->second[act];
+					}
+
+					if (error.str()!="")
+						check.errors.push_back(error.str());
+				}
+
+				//! greedy path without slips
+				unsigned long	current = pos;
+				unsigned long	steps = 0;
+
+				while ((current<states.size()) && (steps<no_positions))
+				{
+					prediction_array(population, states[current], prediction, matched);
+
+					unsigned long	best = no_moves;
+
+					for(unsigned long act=0; act<no_moves; act++)
+					{
+						if (matched[act] && ((best==no_moves) || (prediction[act]>prediction[best])))
+							best = act;
+					}
+
+					if (best==no_moves)
+						break;
+
+					current = environment.transition(current, best);
+					steps++;
+				}
+
+				check.path = (current>=states.size()) && (steps==distance[pos]);
+
+				if (!check.path)
+				{
+					error.str("");
+					if (current<states.size())
+						error << "greedy path does not reach food, the shortest path takes " << distance[pos] << " steps";
+					else
+						error << "greedy path takes " << steps << " steps instead of " << distance[pos];
+					check.errors.push_back(error.str());
+				}
+			}
+		}));
+	}
+
+	for(vector<thread>::iterator t=pool.begin(); t!=pool.end(); t++)
+	{
+		t->join();
+	}
+
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+
+	unsigned long	no_mismatches = 0;
+	unsigned long	no_paths = 0;
+
+	for(unsigned long pos=0; pos<states.size(); pos++)
+	{
+		if (!checks[pos].path)
+			no_paths++;
+
+		if (checks[pos].errors.empty())
+			continue;
+
+		if (no_mismatches<max_reported)
+		{
+			for(vector<string>::const_iterator error=checks[pos].errors.begin(); error!=checks[pos].errors.end(); error++)
+			{
+				cout << "state " << states[pos] << "\t" << *error << endl;
+			}
+		}
+		no_mismatches++;
+	}
+
+	cout << str_population << "\t" << population.size() << " classifiers\t" << states.size() << " states\t";
+	cout << no_mismatches << " mismatching states\t" << no_paths << " non-optimal paths\t" << elapsed << " s" << endl;
+
+	return (no_mismatches==0) ? 0 : 1;
+}
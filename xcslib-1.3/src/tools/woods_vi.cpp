@@ -0,0 +1,326 @@
+/*!
+ * \file woods_vi.cpp
+ *
+ * \brief computes the optimal action-value function of a woods environment by value iteration
+ *
+ * The environment and the discount factor are read from the same configuration file used
+ * by XCS (i.e., confsys.<suffix>). The optimal Q-table is saved with one line for each
+ * sensory configuration and action, with the condition, the action, and the prediction
+ * separated by tabs, i.e., the format that XCS loads with
+ * "initial population = solution:<file>".
+ *
+ * Optionally, the optimal population is computed directly from the reachable states: for each
+ * action, the sensory configurations are partitioned by payoff level and each level is minimized
+ * with the logic minimizer, using the other levels as OFF-set. All the configurations that the
+ * environment never produces are implicit don't cares, thus memory and time depend on the number
+ * of reachable states rather than on 2^n.
+ */
+
+#include <unistd.h>
+#include <map>
+#include "xcs_definitions.h"
+#include "xcs_utility.h"
+#include "minimization_scheduler.h"
+
+//! maximum number of sweeps, it guards against values that oscillate on the last digit
+const unsigned long max_iterations = 100000;
+
+/*!
+ * \fn void value_iteration(const woods_env&, double, double, vector<double>&)
+ * \brief solves the Bellman optimality equations for the environment
+ *
+ * \param environment woods environment
+ * \param discount discount factor
+ * \param epsilon iteration stops when no value changes more than epsilon
+ * \param q action values, stored at position*moves+action
+ * \return number of iterations performed, at most max_iterations
+ *
+ * The agent performs the selected move with probability 1-prob_slide and one of the two
+ * adjacent moves with probability prob_slide/2, as in woods_env::perform. Food positions
+ * are terminal: the move that reaches them is paid with their reward.
+ */
+unsigned long
+value_iteration(const woods_env& environment, const double discount, const double epsilon, vector<double>& q)
+{
+	unsigned long	no_positions = environment.start_positions();
+	unsigned long	no_moves = environment.moves();
+	double			prob_slide = environment.slide_probability();
+
+	vector<double>	value(environment.positions(), 0);	//! V(s)=max Q(s,.), zero for terminal positions
+	vector<double>	payoff(no_positions*no_moves, 0);	//! expected payoff of each move when no slip occurs
+	unsigned long	iteration = 0;
+	double			delta;
+
+	q.assign(no_positions*no_moves, 0);
+
+	do
+	{
+		delta = 0;
+
+		//! payoff of each move without slip
+		for(unsigned long pos=0; pos<no_positions; pos++)
+		{
+			for(unsigned long act=0; act<no_moves; act++)
+			{
+				unsigned long next = environment.transition(pos, act);
+
+				if (next<no_positions)
+					payoff[pos*no_moves+act] = discount*value[next];
+				else
+					payoff[pos*no_moves+act] = environment.reward(next);
+			}
+		}
+
+		//! Bellman update
+		for(unsigned long pos=0; pos<no_positions; pos++)
+		{
+			double	max_q = 0;
+
+			for(unsigned long act=0; act<no_moves; act++)
+			{
+				double	q_value;
+
+				q_value = (1-prob_slide)*payoff[pos*no_moves+act]
+					+ (prob_slide/2)*payoff[pos*no_moves+(act+no_moves-1)%no_moves]
+					+ (prob_slide/2)*payoff[pos*no_moves+(act+1)%no_moves];
+
+				delta = max(delta, fabs(q_value-q[pos*no_moves+act]));
+				q[pos*no_moves+act] = q_value;
+				max_q = max(max_q, q_value);
+			}
+			value[pos] = max_q;
+		}
+
+		iteration++;
+	}
+	while ((delta>epsilon) && (iteration<max_iterations));
+
+	return iteration;
+}
+
+/*!
+ * \fn void optimal_population(const map<string, vector<double> >&, unsigned long, double, ostream&)
+ * \brief saves the minimal population that represents the optimal action-value function
+ *
+ * \param values action values of each reachable sensory configuration
+ * \param no_moves number of actions
+ * \param resolution payoffs are grouped in levels of this width, i.e., payoffs that round to the same multiple are merged
+ * \param output stream where the population is saved
+ * \return number of classifiers saved
+ *
+ * each (action, payoff level) pair is an independent minimization run by the scheduler; the payoff
+ * of each classifier is the average payoff of the configurations in its level
+ */
+unsigned long
+optimal_population(const map<string, vector<double> >& values, const unsigned long no_moves, const double resolution, ostream& output)
+{
+	unsigned long			no_classifiers = 0;
+	minimization_scheduler	scheduler(values.begin()->first.size());
+	const logic_minimizer&	minimizer = scheduler.minimizer();
+
+	vector< vector<unsigned long> >	jobs(no_moves);		//! job of each payoff level of each action
+	vector< vector<double> >		payoff(no_moves);	//! payoff of each level of each action
+
+	for(unsigned long act=0; act<no_moves; act++)
+	{
+		map<long, vector<logic_minimizer::t_cube> >	levels;	//! configurations of each payoff level
+		map<long, double>							sum;	//! sum of the payoffs of each level
+
+		for(map<string, vector<double> >::const_iterator state=values.begin(); state!=values.end(); state++)
+		{
+			long	level = lround(state->second[act]/resolution);
+
+			levels[level].push_back(minimizer.cube(state->first));
+			sum[level] += state->second[act];
+		}
+
+		for(map<long, vector<logic_minimizer::t_cube> >::const_reverse_iterator level=levels.rbegin(); level!=levels.rend(); level++)
+		{
+			vector<logic_minimizer::t_cube>	off_set;
+
+			for(map<long, vector<logic_minimizer::t_cube> >::const_iterator other=levels.begin(); other!=levels.end(); other++)
+			{
+				if (other->first!=level->first)
+					off_set.insert(off_set.end(), other->second.begin(), other->second.end());
+			}
+
+			jobs[act].push_back(scheduler.add(level->second, off_set));
+			payoff[act].push_back(sum[level->first]/level->second.size());
+		}
+	}
+
+	scheduler.run();
+
+	for(unsigned long act=0; act<no_moves; act++)
+	{
+		for(unsigned long level=0; level<jobs[act].size(); level++)
+		{
+			const vector<logic_minimizer::t_cube>& cover = scheduler.cover(jobs[act][level]);
+
+			for(vector<logic_minimizer::t_cube>::const_iterator cube=cover.begin(); cube!=cover.end(); cube++)
+			{
+				output << minimizer.cube_string(*cube) << "\t" << t_action(act) << "\t" << setprecision(12) << payoff[act][level] << endl;
+				no_classifiers++;
+			}
+		}
+	}
+
+	return no_classifiers;
+}
+
+/*!
+ * \fn int main(int Argc, char *Argv[])
+ * \param argc number of arguments
+ * \param argv list of arguments
+ *
+ * computes the optimal Q-table for the woods environment specified in the configuration file
+ */
+int
+main(int argc, char *argv[])
+{
+	string	str_suffix = ""; 		//! configuration file suffix
+	string	str_output = "";		//! output file
+	string	str_population = "";	//! optimal population file, not saved if empty
+	double	resolution = 1;			//! width of the payoff levels of the optimal population
+	double	epsilon = 1e-9;		//! convergence threshold
+	int		o;						//! current option
+
+	if (argc==1)
+	{
+		cerr << "USAGE:\t\t" << argv[0] << "\t" << "-f <suffix> [-o <file>] [-e <epsilon>] [-p <file>] [-r <resolution>]" << endl;
+		cerr << "      \t\t\t\t" << "<suffix>     suffix for the configuration file" << endl;
+		cerr << "      \t\t\t\t" << "-o           output file (default qtable.<suffix>-0000)" << endl;
+		cerr << "      \t\t\t\t" << "-e           stop when no value changes more than epsilon (default 1e-9)" << endl;
+		cerr << "      \t\t\t\t" << "-p           save the optimal population computed from the reachable states" << endl;
+		cerr << "      \t\t\t\t" << "-r           width of the payoff levels of the optimal population (default 1)" << endl;
+		return 0;
+	}
+
+	while ( (o = getopt(argc, argv, "f:o:e:p:r:")) != -1 )
+	{
+		switch (o)
+		{
+			case 'f':
+				str_suffix = string(optarg);
+				break;
+			case 'o':
+				str_output = string(optarg);
+				break;
+			case 'e':
+				epsilon = atof(optarg);
+				break;
+			case 'p':
+				str_population = string(optarg);
+				break;
+			case 'r':
+				resolution = atof(optarg);
+				break;
+			default:
+				xcs_utility::error("main","main","unrecognized option",1);
+		}
+	}
+
+	if (resolution<=0)
+	{
+		xcs_utility::error("main", "main", "the resolution must be positive", 1);
+	}
+
+	if (str_output=="")
+	{
+		str_output = "qtable." + str_suffix + "-0000";
+	}
+
+	//! init the configuration manager
+	xcs_configuration_manager	xcs_config(str_suffix);
+
+	//! init the action class and the environment
+	t_action		dummy_action(xcs_config);
+	t_environment	environment(xcs_config);
+
+	double	discount = xcs_config.Value("classifier_system", "discount factor", 0.7);
+
+	if (environment.moves()!=dummy_action.actions())
+	{
+		xcs_utility::error("main", "main", "the number of actions does not match the number of moves", 1);
+	}
+
+	vector<double>	q;
+	unsigned long	iterations = value_iteration(environment, discount, epsilon, q);
+
+	if (iterations==max_iterations)
+	{
+		cerr << "WARNING: value iteration stopped after " << iterations << " iterations" << endl;
+	} else {
+		clog << "value iteration converged in " << iterations << " iterations" << endl;
+	}
+
+	//! positions with the same sensory inputs are merged; in aliased positions the average value is saved
+	map<string, vector<unsigned long> >	states;
+
+	for(unsigned long pos=0; pos<environment.start_positions(); pos++)
+	{
+		states[environment.sensors(pos)].push_back(pos);
+	}
+
+	ofstream	QTABLE(str_output.c_str());
+
+	if (!QTABLE.good())
+	{
+		xcs_utility::error("main", "main", "output file '" + str_output + "' not open", 1);
+	}
+
+	unsigned long						no_moves = environment.moves();
+	unsigned long						no_aliased = 0;
+	map<string, vector<double> >		values;		//! action values saved for each sensory configuration
+
+	for(map<string, vector<unsigned long> >::const_iterator state=states.begin(); state!=states.end(); state++)
+	{
+		const vector<unsigned long>& pos = state->second;
+
+		for(unsigned long act=0; act<no_moves; act++)
+		{
+			double	sum = 0;
+			bool	aliased = false;
+
+			for(unsigned long p=0; p<pos.size(); p++)
+			{
+				sum += q[pos[p]*no_moves+act];
+				aliased = aliased || (fabs(q[pos[p]*no_moves+act]-q[pos[0]*no_moves+act])>epsilon);
+			}
+
+			if (aliased)
+			{
+				no_aliased++;
+			}
+
+			values[state->first].push_back(sum/pos.size());
+			QTABLE << state->first << "\t" << t_action(act) << "\t" << setprecision(12) << sum/pos.size() << endl;
+		}
+	}
+
+	QTABLE.close();
+
+	if (no_aliased>0)
+	{
+		cerr << "WARNING: " << no_aliased << " state-action pairs are aliased, their average value has been saved" << endl;
+	}
+
+	clog << states.size() << " states saved to " << str_output << endl;
+
+	if (str_population!="")
+	{
+		ofstream	POPULATION(str_population.c_str());
+
+		if (!POPULATION.good())
+		{
+			xcs_utility::error("main", "main", "population file '" + str_population + "' not open", 1);
+		}
+
+		unsigned long	no_classifiers = optimal_population(values, no_moves, resolution, POPULATION);
+
+		POPULATION.close();
+		clog << no_classifiers << " classifiers saved to " << str_population << endl;
+	}
+
+	return 0;
+}
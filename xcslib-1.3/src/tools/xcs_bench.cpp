@@ -0,0 +1,552 @@
+/*!
+ * \file xcs_bench.cpp
+ *
+ * \brief times the kernels of XCS on synthetic populations
+ *
+ * The classifier system is built from the configuration file used by XCS (i.e., confsys.<suffix>),
+ * thus the condition width is the condition size of the file, while the number of classifiers of
+ * the synthetic population is given on the command line. Before each kernel the random generator
+ * is seeded again and the population is filled with random classifiers whose experience, error,
+ * fitness, and action set size are random, so that every kernel works on the same population and
+ * the results of two builds can be compared. For each kernel the time per operation and the
+ * operations per second are printed and saved in JSON.
+ */
+
+#include <unistd.h>
+#include <fstream>
+#include <iomanip>
+#include "xcs_definitions.h"
+#include "xcs_utility.h"
+
+/*!
+ * \class xcs_benchmark
+ * \brief runs the kernels of xcs_classifier_system on a synthetic population
+ */
+class xcs_benchmark
+{
+public:
+	//! name of the class that implements the benchmark
+	string class_name() const { return string("xcs_benchmark"); };
+
+	//! result of a kernel
+	struct t_result {
+		string			name;			//!< kernel
+		unsigned long	operations;		//!< number of operations timed
+		uint64_t		ns;				//!< overall time in nanoseconds
+	};
+
+	/*!
+	 * \brief class constructor
+	 * \param xcs classifier system whose kernels are timed
+	 * \param no_classifiers number of random classifiers inserted in [P]
+	 * \param no_operations number of operations timed for each kernel
+	 * \param seed seed used before each kernel
+	 */
+	xcs_benchmark(t_classifier_system& xcs, const unsigned long no_classifiers, const unsigned long no_operations, const long seed);
+
+	//! run all the kernels
+	void run();
+
+	//! print the results as a table
+	void print(ostream& output) const;
+
+	//! save the results in JSON
+	void save_json(ostream& output, const string& suffix) const;
+
+private:
+	//! number of random inputs used by the kernels
+	static const unsigned long no_inputs = 256;
+
+	//! seed the generator and fill [P] with random classifiers
+	void populate();
+
+	//! a random input of the condition width
+	t_state random_input() const;
+
+	//! build [M] for an input and [A] for the action of a random classifier in [M]; false if [M] is empty
+	bool random_action_set(const t_state& input);
+
+	//! add the result of a kernel
+	void add(const string& name, const unsigned long operations, const uint64_t ns);
+
+	void bench_condition_match();
+	void bench_match();
+	void bench_select_delete_rw();
+	void bench_update();
+	void bench_insert_classifier();
+	void bench_delete_classifier();
+	void bench_genetic_algorithm();
+	void bench_as_subsumption();
+
+	t_classifier_system&	xcs;				//!< classifier system
+	unsigned long			no_classifiers;		//!< classifiers inserted in [P]
+	unsigned long			no_operations;		//!< operations timed for each kernel
+	long					seed;				//!< seed used before each kernel
+	unsigned long			width;				//!< condition width
+
+	vector<t_state>			inputs;				//!< random inputs
+	vector<t_result>		results;			//!< results of the kernels
+	unsigned long			sink;				//!< accumulates the results of the kernels so that they are not optimized away
+};
+
+xcs_benchmark::xcs_benchmark(t_classifier_system& xcs, const unsigned long no_classifiers, const unsigned long no_operations, const long seed) : xcs(xcs)
+{
+	t_condition	condition;
+
+	condition.random();
+
+	this->no_classifiers = no_classifiers;
+	this->no_operations = no_operations;
+	this->seed = seed;
+	this->width = condition.size();
+	this->sink = 0;
+
+	xcs_random::set_seed(seed);
+	for(unsigned long i=0; i<no_inputs; i++)
+	{
+		inputs.push_back(random_input());
+	}
+}
+
+t_state
+xcs_benchmark::random_input() const
+{
+	string	str(width, '0');
+
+	for(unsigned long bit=0; bit<width; bit++)
+	{
+		if (xcs_random::dice(2))
+			str[bit] = '1';
+	}
+	return t_state(str);
+}
+
+/*!
+ * the classifier parameters are spread around the thresholds of XCS so that some classifiers are
+ * accurate and experienced enough to subsume and some are deleted with the accuracy bias
+ */
+void
+xcs_benchmark::populate()
+{
+	xcs_random::set_seed(seed);
+
+	xcs.match_set.clear();
+	xcs.action_set.clear();
+	xcs.previous_action_set.clear();
+	xcs.clear_population();
+	xcs.total_steps = 0;
+	t_classifier::reset_id();
+
+	xcs.max_population_size = no_classifiers;
+	for(unsigned long cl=0; cl<no_classifiers; cl++)
+	{
+		t_classifier	classifier;
+
+		classifier.random();
+		xcs.init_classifier(classifier);
+		xcs.insert_classifier(classifier);
+	}
+
+	for(t_classifier_system::t_set_iterator pp=xcs.population.begin(); pp!=xcs.population.end(); pp++)
+	{
+		(**pp).experience = xcs_random::dice(2*(unsigned int)(max(xcs.theta_as_sub, xcs.theta_del))+1);
+		(**pp).error = 2*xcs.epsilon_zero*xcs_random::random();
+		(**pp).fitness = xcs_random::random()*(**pp).numerosity;
+		(**pp).actionset_size = 1 + 50*xcs_random::random();
+		(**pp).prediction = 1000*xcs_random::random();
+	}
+	xcs.init_population_sums();
+	xcs.max_population_size = xcs.population_size;
+}
+
+bool
+xcs_benchmark::random_action_set(const t_state& input)
+{
+	xcs.match(input);
+	if (xcs.match_set.empty())
+		return false;
+
+	xcs.build_action_set(xcs.match_set[xcs_random::dice(xcs.match_set.size())]->action);
+	return true;
+}
+
+void
+xcs_benchmark::add(const string& name, const unsigned long operations, const uint64_t ns)
+{
+	t_result	result;
+
+	result.name = name;
+	result.operations = operations;
+	result.ns = ns;
+	results.push_back(result);
+}
+
+void
+xcs_benchmark::run()
+{
+	results.clear();
+
+	bench_condition_match();
+	bench_match();
+	bench_select_delete_rw();
+	bench_update();
+	bench_insert_classifier();
+	bench_delete_classifier();
+	bench_genetic_algorithm();
+	bench_as_subsumption();
+
+	populate();
+}
+
+//! each operation matches one condition against one input
+void
+xcs_benchmark::bench_condition_match()
+{
+	vector<t_condition>	conditions(no_classifiers);
+	wall_timer			timer;
+
+	xcs_random::set_seed(seed);
+	for(unsigned long cl=0; cl<no_classifiers; cl++)
+	{
+		conditions[cl].random();
+	}
+
+	timer.start();
+	for(unsigned long op=0; op<no_operations; op++)
+	{
+		const t_state&	input = inputs[op%no_inputs];
+
+		for(unsigned long cl=0; cl<no_classifiers; cl++)
+		{
+			if (conditions[cl].match(input))
+				sink++;
+		}
+	}
+	timer.stop();
+
+	add("ternary_condition::match", no_operations*no_classifiers, timer.elapsed_ns());
+}
+
+//! each operation builds [M] for one input
+void
+xcs_benchmark::bench_match()
+{
+	wall_timer	timer;
+
+	populate();
+
+	timer.start();
+	for(unsigned long op=0; op<no_operations; op++)
+	{
+		sink += xcs.match(inputs[op%no_inputs]);
+	}
+	timer.stop();
+
+	add("xcs_classifier_system::match", no_operations, timer.elapsed_ns());
+}
+
+void
+xcs_benchmark::bench_select_delete_rw()
+{
+	wall_timer	timer;
+
+	populate();
+
+	timer.start();
+	for(unsigned long op=0; op<no_operations; op++)
+	{
+		sink += xcs.select_delete_rw(xcs.population)-xcs.population.begin();
+	}
+	timer.stop();
+
+	add("select_delete_rw", no_operations, timer.elapsed_ns());
+}
+
+/*!
+ * the action sets are built in advance from the random inputs; AS subsumption is disabled while
+ * update_set is timed since it is timed on its own \sa bench_as_subsumption
+ */
+void
+xcs_benchmark::bench_update()
+{
+	vector<t_classifier_system::t_classifier_set>	sets;
+	vector<double>				rewards;
+	wall_timer					timer;
+
+	populate();
+
+	for(unsigned long i=0; i<no_inputs; i++)
+	{
+		if (random_action_set(inputs[i]))
+		{
+			sets.push_back(xcs.action_set);
+			rewards.push_back(1000*xcs_random::dice(2));
+		}
+	}
+
+	if (sets.empty())
+	{
+		add("update_set", 0, 0);
+		add("update_fitness", 0, 0);
+		return;
+	}
+
+	bool	flag_as_subsumption = xcs.flag_as_subsumption;
+
+	xcs.flag_as_subsumption = false;
+	timer.start();
+	for(unsigned long op=0; op<no_operations; op++)
+	{
+		xcs.update_set(rewards[op%sets.size()], sets[op%sets.size()]);
+	}
+	timer.stop();
+	xcs.flag_as_subsumption = flag_as_subsumption;
+
+	add("update_set", no_operations, timer.elapsed_ns());
+
+	timer.start();
+	for(unsigned long op=0; op<no_operations; op++)
+	{
+		xcs.update_fitness(sets[op%sets.size()]);
+	}
+	timer.stop();
+
+	add("update_fitness", no_operations, timer.elapsed_ns());
+}
+
+//! each operation inserts one random classifier in [P], which grows beyond the maximum size
+void
+xcs_benchmark::bench_insert_classifier()
+{
+	vector<t_classifier>	classifiers(no_operations);
+	wall_timer				timer;
+
+	populate();
+
+	for(unsigned long op=0; op<no_operations; op++)
+	{
+		classifiers[op].random();
+		xcs.init_classifier(classifiers[op]);
+	}
+
+	timer.start();
+	for(unsigned long op=0; op<no_operations; op++)
+	{
+		xcs.insert_classifier(classifiers[op]);
+	}
+	timer.stop();
+
+	add("insert_classifier", no_operations, timer.elapsed_ns());
+}
+
+//! each operation deletes one micro classifier from [P], which shrinks at most to one classifier
+void
+xcs_benchmark::bench_delete_classifier()
+{
+	wall_timer	timer;
+
+	populate();
+
+	unsigned long	operations = min(no_operations, xcs.population_size-1);
+
+	xcs.max_population_size = xcs.population_size-operations;
+
+	timer.start();
+	for(unsigned long op=0; op<operations; op++)
+	{
+		xcs.delete_classifier();
+	}
+	timer.stop();
+
+	add("delete_classifier", operations, timer.elapsed_ns());
+}
+
+//! each operation is one invocation of the GA on a random [A], including insertion and deletion
+void
+xcs_benchmark::bench_genetic_algorithm()
+{
+	unsigned long	operations = 0;
+	uint64_t		ns = 0;
+	wall_timer		timer;
+
+	populate();
+
+	for(unsigned long op=0; op<no_operations; op++)
+	{
+		const t_state&	input = inputs[op%no_inputs];
+
+		if (!random_action_set(input))
+			continue;
+
+		timer.start();
+		xcs.genetic_algorithm(xcs.action_set, input);
+		timer.stop();
+
+		ns += timer.elapsed_ns();
+		operations++;
+	}
+
+	add("genetic_algorithm", operations, ns);
+}
+
+//! each operation performs AS subsumption on a random [A]; the subsumed classifiers leave [P]
+void
+xcs_benchmark::bench_as_subsumption()
+{
+	unsigned long	operations = 0;
+	uint64_t		ns = 0;
+	wall_timer		timer;
+
+	populate();
+
+	for(unsigned long op=0; op<no_operations; op++)
+	{
+		if (!random_action_set(inputs[op%no_inputs]))
+			continue;
+
+		timer.start();
+		xcs.do_as_subsumption(xcs.action_set);
+		timer.stop();
+
+		ns += timer.elapsed_ns();
+		operations++;
+	}
+
+	add("do_as_subsumption", operations, ns);
+}
+
+void
+xcs_benchmark::print(ostream& output) const
+{
+	output << "Kernel\t\t\t\tOperations\tns/op\t\tops/s" << endl;
+	for(vector<t_result>::const_iterator result=results.begin(); result!=results.end(); result++)
+	{
+		double	ns_per_op = (result->operations>0) ? double(result->ns)/result->operations : 0;
+
+		output << result->name << ((result->name.size()<16) ? "\t\t\t" : ((result->name.size()<24) ? "\t\t" : "\t"));
+		output << result->operations << "\t\t";
+		output << fixed << setprecision(1) << ns_per_op << "\t\t";
+		output << setprecision(0) << ((ns_per_op>0) ? 1e9/ns_per_op : 0) << endl;
+		output.unsetf(ios::floatfield);
+	}
+}
+
+//! one kernel for each line, in the same order, so that two files can be compared with diff
+void
+xcs_benchmark::save_json(ostream& output, const string& suffix) const
+{
+	output << "{" << endl;
+	output << "\t\"configuration\": \"" << suffix << "\"," << endl;
+	output << "\t\"condition width\": " << width << "," << endl;
+	output << "\t\"classifiers\": " << no_classifiers << "," << endl;
+	output << "\t\"operations\": " << no_operations << "," << endl;
+	output << "\t\"seed\": " << seed << "," << endl;
+	output << "\t\"kernels\": [" << endl;
+	for(vector<t_result>::const_iterator result=results.begin(); result!=results.end(); result++)
+	{
+		double	ns_per_op = (result->operations>0) ? double(result->ns)/result->operations : 0;
+
+		output << "\t\t{\"name\": \"" << result->name << "\", ";
+		output << "\"operations\": " << result->operations << ", ";
+		output << fixed << setprecision(1) << "\"ns/op\": " << ns_per_op << ", ";
+		output << setprecision(0) << "\"ops/s\": " << ((ns_per_op>0) ? 1e9/ns_per_op : 0) << "}";
+		output.unsetf(ios::floatfield);
+		output << ((result+1!=results.end()) ? "," : "") << endl;
+	}
+	output << "\t]" << endl;
+	output << "}" << endl;
+}
+
+/*!
+ * \fn int main(int argc, char *argv[])
+ * \param argc number of arguments
+ * \param argv list of arguments
+ *
+ * times the kernels and saves the results in bench.<suffix>.json
+ */
+int
+main(int argc, char *argv[])
+{
+	string			str_suffix = "";		//! configuration file suffix
+	string			str_output = "";		//! JSON file
+	unsigned long	no_classifiers = 0;		//! classifiers in [P], the population size of the configuration if zero
+	unsigned long	no_operations = 10000;	//! operations for each kernel
+	long			seed = 1;				//! seed of the random generator
+	int				o;						//! current option
+
+	if (argc==1)
+	{
+		cerr << "USAGE:\t\t" << argv[0] << "\t" << "-f <suffix> [-n <classifiers>] [-r <operations>] [-s <seed>] [-o <file>]" << endl;
+		cerr << "      \t\t\t\t" << "<suffix>     suffix for the configuration file, which sets the condition width" << endl;
+		cerr << "      \t\t\t\t" << "-n           classifiers in the synthetic population (default the population size)" << endl;
+		cerr << "      \t\t\t\t" << "-r           operations timed for each kernel (default 10000)" << endl;
+		cerr << "      \t\t\t\t" << "-s           seed of the random generator (default 1)" << endl;
+		cerr << "      \t\t\t\t" << "-o           JSON file (default bench.<suffix>.json)" << endl;
+		return 0;
+	}
+
+	while ( (o = getopt(argc, argv, "f:n:r:s:o:")) != -1 )
+	{
+		switch (o)
+		{
+			case 'f':
+				str_suffix = string(optarg);
+				break;
+			case 'n':
+				no_classifiers = atol(optarg);
+				break;
+			case 'r':
+				no_operations = atol(optarg);
+				break;
+			case 's':
+				seed = atol(optarg);
+				break;
+			case 'o':
+				str_output = string(optarg);
+				break;
+			default:
+				xcs_utility::error("main","main","unrecognized option",1);
+		}
+	}
+
+	if (str_output=="")
+	{
+		str_output = "bench." + str_suffix + ".json";
+	}
+
+	xcs_configuration_manager	xcs_config(str_suffix);
+
+	xcs_random::set_seed(xcs_config);
+
+	t_action				dummy_action(xcs_config);
+	t_environment			environment(xcs_config);
+	t_condition				dummy_condition(xcs_config);
+	t_classifier_system		xcs(xcs_config, &environment);
+
+	if (no_classifiers==0)
+	{
+		no_classifiers = (unsigned long) xcs_config.Value(xcs.tag_name(), "population size");
+	}
+
+	if ((no_classifiers==0) || (no_operations==0))
+	{
+		xcs_utility::error("main", "main", "the number of classifiers and of operations must be positive", 1);
+	}
+
+	xcs_benchmark	benchmark(xcs, no_classifiers, no_operations, seed);
+
+	benchmark.run();
+	benchmark.print(cout);
+
+	ofstream	OUTPUT(str_output.c_str());
+
+	if (!OUTPUT.good())
+	{
+		xcs_utility::error("main", "main", "JSON file '" + str_output + "' not open", 1);
+	}
+
+	benchmark.save_json(OUTPUT, str_suffix);
+	OUTPUT.close();
+
+	return 0;
+}
@@ -0,0 +1,91 @@
+/*!
+ * \file latency_histogram.cpp
+ *
+ * \brief implements the histogram of latencies
+ *
+ */
+
+#include <iomanip>
+#include <algorithm>
+#include "latency_histogram.h"
+
+//! all the 64 bit values are indexed, i.e., 2*sub_buckets exact values plus sub_buckets for each larger power of two
+latency_histogram::latency_histogram() : counts((64-sub_bucket_bits+1)*sub_buckets, 0)
+{
+	reset();
+}
+
+void
+latency_histogram::reset()
+{
+	fill(counts.begin(), counts.end(), 0);
+	no_values = 0;
+	sum = 0;
+	minimum = UINT64_MAX;
+	maximum = 0;
+}
+
+void
+latency_histogram::merge(const latency_histogram& histogram)
+{
+	for(unsigned long i=0; i<counts.size(); i++)
+	{
+		counts[i] += histogram.counts[i];
+	}
+	no_values += histogram.no_values;
+	sum += histogram.sum;
+	if (histogram.minimum<minimum)
+		minimum = histogram.minimum;
+	if (histogram.maximum>maximum)
+		maximum = histogram.maximum;
+}
+
+uint64_t
+latency_histogram::highest_value(const unsigned long index)
+{
+	if (index<2*sub_buckets)
+		return index;
+
+	unsigned long	shift = index/sub_buckets - 1;
+	uint64_t		sub_bucket = index%sub_buckets + sub_buckets;
+
+	return ((sub_bucket+1) << shift) - 1;
+}
+
+/*!
+ * the sub-buckets are scanned until the required number of values is reached; the value reported
+ * is the largest one of that sub-bucket, but never larger than the maximum recorded
+ */
+uint64_t
+latency_histogram::percentile(const double percentage) const
+{
+	if (no_values==0)
+		return 0;
+
+	uint64_t	rank = (uint64_t) (percentage/100.0*no_values + 0.5);
+	uint64_t	seen = 0;
+
+	if (rank<1)
+		rank = 1;
+	if (rank>no_values)
+		rank = no_values;
+
+	for(unsigned long i=0; i<counts.size(); i++)
+	{
+		seen += counts[i];
+		if (seen>=rank)
+			return (highest_value(i)<maximum) ? highest_value(i) : maximum;
+	}
+	return maximum;
+}
+
+void
+latency_histogram::print(ostream& output) const
+{
+	output << no_values << "\t";
+	output << setprecision(4) << mean()*1e-6 << "\t";
+	output << setprecision(4) << percentile(50)*1e-6 << "\t";
+	output << setprecision(4) << percentile(90)*1e-6 << "\t";
+	output << setprecision(4) << percentile(99)*1e-6 << "\t";
+	output << setprecision(4) << max()*1e-6;
+}
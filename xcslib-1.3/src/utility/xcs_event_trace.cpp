@@ -0,0 +1,256 @@
+/*!
+ * \file xcs_event_trace.cpp
+ *
+ * \brief implements the trace of timed events
+ *
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include "xcs_event_trace.h"
+#include "xcs_utility.h"
+
+atomic<bool>					xcs_event_trace::enabled(false);
+unsigned long					xcs_event_trace::steps_interval = 0;
+uint64_t						xcs_event_trace::origin = 0;
+mutex							xcs_event_trace::buffers_mutex;
+vector<unique_ptr<xcs_event_trace::t_buffer>>	xcs_event_trace::buffers;
+FILE							*xcs_event_trace::output = NULL;
+bool							xcs_event_trace::flag_first = true;
+thread							xcs_event_trace::writer;
+mutex							xcs_event_trace::writer_mutex;
+condition_variable				xcs_event_trace::writer_wakeup;
+bool							xcs_event_trace::flag_stop = false;
+bool							xcs_event_trace::flag_exit = false;
+thread_local xcs_event_trace::t_owner	xcs_event_trace::owner = {NULL};
+
+uint64_t
+xcs_event_trace::now()
+{
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count()-origin;
+}
+
+/*!
+ * the file is written as a JSON array of events, which chrome://tracing and Perfetto accept even
+ * when the closing bracket is missing, i.e., when the run did not end; the calling thread is
+ * shown as the main track
+ */
+void
+xcs_event_trace::open(const string& filename, const unsigned long step_interval)
+{
+	close();
+
+	output = fopen(filename.c_str(), "w");
+	if (output==NULL)
+	{
+		xcs_utility::error(class_name(), "open", "Event trace file '"+filename+"' not open", 1);
+	}
+	fprintf(output, "[");
+
+	//! the buffers of a previous trace are reused, their events have been saved by close
+	{
+		lock_guard<mutex>	lock(buffers_mutex);
+
+		for(unsigned long b=0; b<buffers.size(); b++)
+		{
+			buffers[b]->dropped.store(0);
+			buffers[b]->named = false;
+		}
+	}
+
+	steps_interval = step_interval;
+	origin = 0;
+	origin = now();
+	flag_first = true;
+	flag_stop = false;
+	thread_buffer();
+	enabled.store(true);
+
+	writer = thread(write);
+
+	//! the program may exit with the trace open, e.g., through xcs_utility::error; the writer must end before it is destroyed, otherwise the program is terminated
+	if (!flag_exit)
+	{
+		atexit(close);
+		flag_exit = true;
+	}
+}
+
+void
+xcs_event_trace::close()
+{
+	if (!enabled.load())
+		return;
+
+	enabled.store(false);
+	{
+		lock_guard<mutex>	lock(writer_mutex);
+		flag_stop = true;
+	}
+	writer_wakeup.notify_one();
+
+	//! the writer cannot join itself, which happens if it makes the program exit
+	if (writer.get_id()==this_thread::get_id())
+		writer.detach();
+	else
+		writer.join();
+
+	//! the events dropped by each thread are reported at the end of its track
+	uint64_t			end = now();
+	lock_guard<mutex>	lock(buffers_mutex);
+
+	for(unsigned long b=0; b<buffers.size(); b++)
+	{
+		if (buffers[b]->dropped.load()>0)
+		{
+			fprintf(output, ",\n{\"name\":\"dropped events\",\"cat\":\"trace\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"args\":{\"events\":%llu}}",
+				buffers[b]->tid, end*1e-3, (unsigned long long) buffers[b]->dropped.load());
+		}
+	}
+	fprintf(output, "\n]\n");
+	fclose(output);
+	output = NULL;
+}
+
+xcs_event_trace::t_buffer*
+xcs_event_trace::thread_buffer()
+{
+	if (owner.buffer!=NULL)
+		return owner.buffer;
+
+	lock_guard<mutex>	lock(buffers_mutex);
+
+	//! the buffer of a thread that has ended is reused once the writer has saved all its events
+	for(unsigned long b=0; b<buffers.size(); b++)
+	{
+		t_buffer	*buffer = buffers[b].get();
+
+		if (buffer->released.load(memory_order_acquire) && (buffer->tail.load(memory_order_acquire)==buffer->head.load(memory_order_relaxed)))
+		{
+			buffer->released.store(false, memory_order_relaxed);
+			owner.buffer = buffer;
+			return buffer;
+		}
+	}
+
+	buffers.emplace_back(new t_buffer());
+
+	t_buffer	*buffer = buffers.back().get();
+
+	buffer->events.resize(buffer_size);
+	buffer->head.store(0);
+	buffer->tail.store(0);
+	buffer->dropped.store(0);
+	buffer->released.store(false);
+	buffer->tid = buffers.size()-1;
+	buffer->named = false;
+
+	owner.buffer = buffer;
+	return buffer;
+}
+
+void
+xcs_event_trace::record(const t_event &event)
+{
+	t_buffer	*buffer = thread_buffer();
+	uint64_t	head = buffer->head.load(memory_order_relaxed);
+
+	if (head-buffer->tail.load(memory_order_acquire)>=buffer_size)
+	{
+		buffer->dropped.fetch_add(1, memory_order_relaxed);
+		return;
+	}
+
+	buffer->events[head & (buffer_size-1)] = event;
+	buffer->head.store(head+1, memory_order_release);
+}
+
+void
+xcs_event_trace::complete(const char *name, const char *category, const uint64_t start, const char *arg_name, const int64_t arg)
+{
+	if (!is_open())
+		return;
+
+	t_event	event = {name, category, arg_name, arg, start, now()-start, 'X'};
+
+	record(event);
+}
+
+void
+xcs_event_trace::instant(const char *name, const char *category, const char *arg_name, const int64_t arg)
+{
+	if (!is_open())
+		return;
+
+	t_event	event = {name, category, arg_name, arg, now(), 0, 'i'};
+
+	record(event);
+}
+
+//! times are saved in microseconds, as required by the format
+void
+xcs_event_trace::drain()
+{
+	vector<t_buffer*>	active;
+
+	{
+		lock_guard<mutex>	lock(buffers_mutex);
+
+		for(unsigned long b=0; b<buffers.size(); b++)
+			active.push_back(buffers[b].get());
+	}
+
+	for(unsigned long b=0; b<active.size(); b++)
+	{
+		t_buffer	*buffer = active[b];
+		uint64_t	tail = buffer->tail.load(memory_order_relaxed);
+		uint64_t	head = buffer->head.load(memory_order_acquire);
+
+		if ((tail==head) && buffer->named)
+			continue;
+
+		if (!buffer->named)
+		{
+			string	track = (buffer->tid==0) ? string("main") : "thread "+to_string(buffer->tid);
+
+			fprintf(output, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+				(flag_first ? "" : ","), buffer->tid, track.c_str());
+			flag_first = false;
+			buffer->named = true;
+		}
+
+		for(; tail!=head; tail++)
+		{
+			const t_event	&event = buffer->events[tail & (buffer_size-1)];
+
+			fprintf(output, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f",
+				event.name, event.category, event.phase, buffer->tid, event.start*1e-3);
+			if (event.phase=='X')
+				fprintf(output, ",\"dur\":%.3f", event.duration*1e-3);
+			else
+				fprintf(output, ",\"s\":\"t\"");
+			if (event.arg_name!=NULL)
+				fprintf(output, ",\"args\":{\"%s\":%lld}", event.arg_name, (long long) event.arg);
+			fprintf(output, "}");
+		}
+		buffer->tail.store(head, memory_order_release);
+	}
+	fflush(output);
+}
+
+//! the writer wakes up every 10 milliseconds and, when the trace is closed, it saves what is left
+void
+xcs_event_trace::write()
+{
+	unique_lock<mutex>	lock(writer_mutex);
+
+	while (!flag_stop)
+	{
+		writer_wakeup.wait_for(lock, chrono::milliseconds(10));
+		lock.unlock();
+		drain();
+		lock.lock();
+	}
+	lock.unlock();
+	drain();
+}
@@ -0,0 +1,284 @@
+/*!
+ * \file xcs_interaction_stream.cpp
+ *
+ * \brief implements the log of the interaction with the environment
+ *
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include "xcs_interaction_stream.h"
+#include "xcs_utility.h"
+
+//! magic string at the beginning of the log
+static const char	stream_magic[] = "XCSSTRM1";
+
+void
+xcs_interaction_stream::open(const string& filename, const unsigned long seed, const unsigned long no_actions, const bool single_step)
+{
+	close();
+
+	output = fopen(filename.c_str(), "wb");
+	if (output==NULL)
+	{
+		xcs_utility::error(class_name(), "open", "Interaction stream file '"+filename+"' not open", 1);
+	}
+
+	no_bytes = 0;
+	state_size = 0;
+	for(unsigned long c=0; c<strlen(stream_magic); c++)
+		write_byte(stream_magic[c]);
+	write_number(seed);
+	write_number(no_actions);
+	write_byte(single_step ? 1 : 0);
+}
+
+void
+xcs_interaction_stream::close()
+{
+	if (output==NULL)
+		return;
+
+	fclose(output);
+	output = NULL;
+}
+
+void
+xcs_interaction_stream::write_byte(const unsigned char value)
+{
+	putc(value, output);
+	no_bytes++;
+}
+
+//! seven bits per byte, the highest bit is set in all the bytes but the last
+void
+xcs_interaction_stream::write_number(unsigned long long value)
+{
+	while (value>=0x80)
+	{
+		write_byte((unsigned char) (value|0x80));
+		value >>= 7;
+	}
+	write_byte((unsigned char) value);
+}
+
+//! the first input is the highest bit of the first byte
+void
+xcs_interaction_stream::write_state(const string& state)
+{
+	if (state.size()!=state_size)
+	{
+		xcs_utility::error(class_name(), "step", "state '"+state+"' has not the size of the first state of the problem", 1);
+	}
+
+	packed.assign((state_size+7)/8, 0);
+	for(unsigned long i=0; i<state_size; i++)
+	{
+		if (state[i]=='1')
+			packed[i>>3] |= (unsigned char) (0x80>>(i&7));
+		else if (state[i]!='0')
+			xcs_utility::error(class_name(), "step", "state '"+state+"' is not a binary string", 1);
+	}
+	fwrite(packed.data(), 1, packed.size(), output);
+	no_bytes += packed.size();
+}
+
+void
+xcs_interaction_stream::begin_experiment(const unsigned long experiment)
+{
+	write_byte('E');
+	write_number(experiment);
+}
+
+void
+xcs_interaction_stream::begin_problem(const bool exploration, const unsigned long long draws, const string& state)
+{
+	state_size = state.size();
+	write_byte('P');
+	write_byte(exploration ? 1 : 0);
+	write_number(draws);
+	write_number(state_size);
+}
+
+void
+xcs_interaction_stream::step(const string& state, const unsigned long action, const double reward, const bool stop, const unsigned long long draws)
+{
+	write_byte(stop ? 'T' : 'S');
+	write_state(state);
+	write_number(action);
+	fwrite(&reward, sizeof(reward), 1, output);
+	no_bytes += sizeof(reward);
+	write_number(draws);
+}
+
+/*!
+ * the whole file is loaded and decoded at once, thus the replay does not read the disk while the
+ * classifier system runs; a log that ends in the middle of a record, e.g., because the recorded
+ * run was interrupted, is read up to its last complete record
+ */
+void
+xcs_interaction_stream::read(const string& filename)
+{
+	ifstream						input(filename.c_str(), ios::binary);
+	vector<unsigned char>			data;
+	unordered_map<string, unsigned long>	state_index;
+	unsigned long					pos = 0;
+	unsigned long					size = 0;
+	bool							flag_truncated = false;
+
+	if (!input.is_open())
+	{
+		xcs_utility::error(class_name(), "read", "Interaction stream file '"+filename+"' not found", 1);
+	}
+	data.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+
+	states.clear();
+	steps.clear();
+	problems.clear();
+	experiments.clear();
+
+	if ((data.size()<strlen(stream_magic)) || (memcmp(data.data(), stream_magic, strlen(stream_magic))!=0))
+	{
+		xcs_utility::error(class_name(), "read", "'"+filename+"' is not an interaction stream", 1);
+	}
+	pos = strlen(stream_magic);
+
+	//! the readers return false when the data ends before the value
+	auto read_number = [&](unsigned long long &value) -> bool {
+		value = 0;
+		for(unsigned long shift=0; pos<data.size(); shift+=7)
+		{
+			unsigned char	byte = data[pos++];
+
+			value |= ((unsigned long long) (byte&0x7f))<<shift;
+			if (!(byte&0x80))
+				return true;
+		}
+		return false;
+	};
+
+	unsigned long long	number;
+
+	if (!read_number(number))
+		xcs_utility::error(class_name(), "read", "'"+filename+"' has a truncated header", 1);
+	seed = number;
+	if (!read_number(number) || (pos>=data.size()))
+		xcs_utility::error(class_name(), "read", "'"+filename+"' has a truncated header", 1);
+	no_actions = number;
+	single_step = (data[pos++]!=0);
+
+	while ((pos<data.size()) && !flag_truncated)
+	{
+		unsigned long	record = pos;
+		unsigned char	tag = data[pos++];
+
+		switch (tag)
+		{
+			case 'E':
+			{
+				t_experiment	experiment;
+
+				if (!read_number(number))
+				{
+					flag_truncated = true;
+					break;
+				}
+				experiment.number = number;
+				experiment.first_problem = problems.size();
+				experiment.no_problems = 0;
+				experiments.push_back(experiment);
+				break;
+			}
+			case 'P':
+			{
+				t_problem		problem;
+
+				if (experiments.empty())
+					xcs_utility::error(class_name(), "read", "'"+filename+"' has a problem outside any experiment", 1);
+				if (pos>=data.size())
+				{
+					flag_truncated = true;
+					break;
+				}
+				problem.exploration = (data[pos++]!=0);
+				if (!read_number(number))
+				{
+					flag_truncated = true;
+					break;
+				}
+				problem.draws = number;
+				if (!read_number(number))
+				{
+					flag_truncated = true;
+					break;
+				}
+				size = number;
+				problem.first_step = steps.size();
+				problem.no_steps = 0;
+				problems.push_back(problem);
+				experiments.back().no_problems++;
+				break;
+			}
+			case 'S':
+			case 'T':
+			{
+				t_step			step;
+				string			state(size, '0');
+				unsigned long	no_packed = (size+7)/8;
+
+				if (problems.empty())
+					xcs_utility::error(class_name(), "read", "'"+filename+"' has a step outside any problem", 1);
+				if (pos+no_packed>data.size())
+				{
+					flag_truncated = true;
+					break;
+				}
+				for(unsigned long i=0; i<size; i++)
+				{
+					if (data[pos+(i>>3)] & (0x80>>(i&7)))
+						state[i] = '1';
+				}
+				pos += no_packed;
+
+				if (!read_number(number) || (pos+sizeof(double)>data.size()))
+				{
+					flag_truncated = true;
+					break;
+				}
+				step.action = number;
+				memcpy(&step.reward, data.data()+pos, sizeof(double));
+				pos += sizeof(double);
+				if (!read_number(number))
+				{
+					flag_truncated = true;
+					break;
+				}
+				step.draws = number;
+				step.stop = (tag=='T');
+
+				auto	found = state_index.find(state);
+
+				if (found==state_index.end())
+				{
+					found = state_index.emplace(state, states.size()).first;
+					states.push_back(state);
+				}
+				step.state = found->second;
+
+				steps.push_back(step);
+				problems.back().no_steps++;
+				break;
+			}
+			default:
+				xcs_utility::error(class_name(), "read", "'"+filename+"' has an unknown record at byte "+to_string(record), 1);
+		}
+
+		//! records are added only once complete, thus the partial one is just ignored
+		if (flag_truncated)
+		{
+			xcs_utility::warning(class_name(), "read", "'"+filename+"' is truncated at byte "+to_string(record));
+		}
+	}
+}
@@ -0,0 +1,57 @@
+/*!
+ * \file xcs_memory_usage.cpp
+ *
+ * \brief implements the accounting of the memory of the classifier system
+ *
+ */
+
+#include <iomanip>
+#include "xcs_memory_usage.h"
+
+void
+xcs_memory_usage::reset()
+{
+	peak_bytes = live_bytes;
+	peak_macro = 0;
+	peak_micro = 0;
+	no_allocations = 0;
+	no_releases = 0;
+	allocated_bytes = 0;
+	no_samples = 0;
+	match_set_sum = 0;
+	action_set_sum = 0;
+	peak_match_set = 0;
+	peak_action_set = 0;
+	container_bytes = 0;
+}
+
+void
+xcs_memory_usage::print_header(ostream& output)
+{
+	output << "LiveKB\tPeakKB\tBytesPerClassifier\tPeakMacro\tPeakMicro\tAllocations\tReleases\tChurnKB\t";
+	output << "MeanM\tPeakM\tMeanMKB\tMeanA\tPeakA\tMeanAKB\tSetsKB";
+}
+
+//! sizes are in KB, the averages of [M] and [A] in macro classifiers per step
+void
+xcs_memory_usage::print(ostream& output) const
+{
+	double	mean_match_set = (no_samples>0) ? match_set_sum/no_samples : 0;
+	double	mean_action_set = (no_samples>0) ? action_set_sum/no_samples : 0;
+
+	output << setprecision(6) << live_bytes/1024.0 << "\t";
+	output << setprecision(6) << peak_bytes/1024.0 << "\t";
+	output << setprecision(4) << classifier_bytes() << "\t";
+	output << peak_macro << "\t";
+	output << peak_micro << "\t";
+	output << no_allocations << "\t";
+	output << no_releases << "\t";
+	output << setprecision(6) << allocated_bytes/1024.0 << "\t";
+	output << setprecision(4) << mean_match_set << "\t";
+	output << peak_match_set << "\t";
+	output << setprecision(4) << mean_match_set*classifier_bytes()/1024.0 << "\t";
+	output << setprecision(4) << mean_action_set << "\t";
+	output << peak_action_set << "\t";
+	output << setprecision(4) << mean_action_set*classifier_bytes()/1024.0 << "\t";
+	output << setprecision(6) << container_bytes/1024.0;
+}
@@ -0,0 +1,300 @@
+/*!
+ * \file xcs_metrics.cpp
+ *
+ * \brief implements the live metrics server
+ *
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+#include <iomanip>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "xcs_metrics.h"
+#include "xcs_utility.h"
+
+const unsigned long	xcs_metrics::window;
+
+xcs_metrics::xcs_metrics() : sequence(0), socket_fd(-1), flag_stop(false), running(false)
+{
+	start_ns = now();
+	begin_experiment(0);
+}
+
+/*!
+ * a socket left by a previous run with the same path is removed; the server polls the socket so
+ * that it notices within 100 milliseconds that it must stop
+ */
+bool
+xcs_metrics::start(const string& path)
+{
+	struct sockaddr_un	address;
+
+	stop();
+
+	if (path.size()>=sizeof(address.sun_path))
+	{
+		xcs_utility::warning(class_name(), "start", "socket path '"+path+"' too long, live metrics disabled");
+		return false;
+	}
+
+	socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socket_fd==-1)
+	{
+		xcs_utility::warning(class_name(), "start", string("socket not created (")+strerror(errno)+"), live metrics disabled");
+		return false;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path)-1);
+	unlink(path.c_str());
+
+	if ((bind(socket_fd, (struct sockaddr*) &address, sizeof(address))==-1) || (listen(socket_fd, 8)==-1))
+	{
+		xcs_utility::warning(class_name(), "start", "socket '"+path+"' not bound ("+strerror(errno)+"), live metrics disabled");
+		close(socket_fd);
+		socket_fd = -1;
+		return false;
+	}
+
+	socket_path = path;
+	start_ns = now();
+	flag_stop.store(false);
+	running = true;
+	publish();
+	server = std::thread([this]() { serve(); });
+	return true;
+}
+
+void
+xcs_metrics::stop()
+{
+	if (!running)
+		return;
+
+	flag_stop.store(true);
+	server.join();
+	close(socket_fd);
+	socket_fd = -1;
+	unlink(socket_path.c_str());
+	running = false;
+}
+
+void
+xcs_metrics::begin_experiment(const unsigned long experiment)
+{
+	memset(&current, 0, sizeof(current));
+	current.experiment = experiment;
+	current.exploration = 1;
+	rate_start_ns = now();
+	rate_start_steps = 0;
+	rate_start_problems = 0;
+	learning_latency_sum = 0;
+	testing_latency_sum = 0;
+	if (running)
+		publish();
+}
+
+/*!
+ * the rates are updated once the last one is older than a second, thus they are the rates over
+ * the last second or so; the rolling averages are computed from scratch over the window, which is
+ * short enough for this to cost less than solving a problem
+ */
+void
+xcs_metrics::problem(const unsigned long problem_no, const bool exploration, const unsigned long steps, const double reward, const double system_error, const uint64_t latency_ns, const unsigned long macro_size, const unsigned long micro_size, const xcs_profiler& profiler)
+{
+	if (!running)
+		return;
+
+	uint64_t	time = now();
+
+	current.problem = problem_no;
+	current.exploration = exploration;
+	current.steps += steps;
+	current.macro_size = macro_size;
+	current.micro_size = micro_size;
+
+	if (exploration)
+	{
+		current.learning_problems++;
+		learning_latency_sum += latency_ns;
+		current.learning_latency_ms = learning_latency_sum*1e-6/current.learning_problems;
+	} else {
+		unsigned long	slot = current.test_problems%window;
+
+		window_reward[slot] = reward;
+		window_steps[slot] = steps;
+		window_system_error[slot] = system_error;
+		current.test_problems++;
+		testing_latency_sum += latency_ns;
+		current.testing_latency_ms = testing_latency_sum*1e-6/current.test_problems;
+
+		current.no_window = (current.test_problems<window) ? current.test_problems : window;
+		current.rolling_reward = 0;
+		current.rolling_steps = 0;
+		current.rolling_system_error = 0;
+		for(unsigned long i=0; i<current.no_window; i++)
+		{
+			current.rolling_reward += window_reward[i];
+			current.rolling_steps += window_steps[i];
+			current.rolling_system_error += window_system_error[i];
+		}
+		current.rolling_reward /= current.no_window;
+		current.rolling_steps /= current.no_window;
+		current.rolling_system_error /= current.no_window;
+	}
+
+	if (time-rate_start_ns>=1000000000ULL)
+	{
+		double	elapsed = (time-rate_start_ns)*1e-9;
+		uint64_t	problems = current.learning_problems+current.test_problems;
+
+		current.steps_per_second = (current.steps-rate_start_steps)/elapsed;
+		current.problems_per_second = (problems-rate_start_problems)/elapsed;
+		rate_start_ns = time;
+		rate_start_steps = current.steps;
+		rate_start_problems = problems;
+	}
+
+	if (xcs_profiler::enabled)
+	{
+		for(unsigned long p=0; p<xcs_profiler::NO_PHASES; p++)
+		{
+			current.phase_calls[p] = profiler.calls((xcs_profiler::t_phase) p);
+			current.phase_self_ns[p] = profiler.self_time((xcs_profiler::t_phase) p);
+			current.phase_inclusive_ns[p] = profiler.inclusive_time((xcs_profiler::t_phase) p);
+		}
+	}
+
+	publish();
+}
+
+//! the words are written between two increments of the sequence, which is odd in between
+void
+xcs_metrics::publish()
+{
+	uint64_t	buffer[no_words];
+	uint64_t	seq = sequence.load(memory_order_relaxed);
+
+	current.uptime_ns = now()-start_ns;
+	memset(buffer, 0, sizeof(buffer));
+	memcpy(buffer, &current, sizeof(current));
+
+	sequence.store(seq+1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	for(unsigned long w=0; w<no_words; w++)
+		words[w].store(buffer[w], memory_order_relaxed);
+	sequence.store(seq+2, memory_order_release);
+}
+
+//! the copy is repeated until no snapshot was published while it was taken
+void
+xcs_metrics::read(t_snapshot& snapshot) const
+{
+	uint64_t	buffer[no_words];
+	uint64_t	before, after;
+
+	do
+	{
+		before = sequence.load(memory_order_acquire);
+		for(unsigned long w=0; w<no_words; w++)
+			buffer[w] = words[w].load(memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+		after = sequence.load(memory_order_relaxed);
+	}
+	while ((before!=after) || (before&1));
+
+	memcpy(&snapshot, buffer, sizeof(snapshot));
+}
+
+void
+xcs_metrics::print(ostream& output, const t_snapshot& snapshot)
+{
+	output << setprecision(6);
+	output << "{\"uptime_s\":" << snapshot.uptime_ns*1e-9;
+	output << ",\"experiment\":" << snapshot.experiment;
+	output << ",\"problem\":" << snapshot.problem;
+	output << ",\"mode\":\"" << (snapshot.exploration ? "learning" : "testing") << "\"";
+	output << ",\"learning_problems\":" << snapshot.learning_problems;
+	output << ",\"test_problems\":" << snapshot.test_problems;
+	output << ",\"steps\":" << snapshot.steps;
+	output << ",\"steps_per_second\":" << snapshot.steps_per_second;
+	output << ",\"problems_per_second\":" << snapshot.problems_per_second;
+	output << ",\"population\":{\"macro\":" << snapshot.macro_size << ",\"micro\":" << snapshot.micro_size << "}";
+	output << ",\"rolling\":{\"window\":" << snapshot.no_window;
+	output << ",\"reward\":" << snapshot.rolling_reward;
+	output << ",\"steps\":" << snapshot.rolling_steps;
+	output << ",\"system_error\":" << snapshot.rolling_system_error << "}";
+	output << ",\"latency_ms\":{\"learning\":" << snapshot.learning_latency_ms << ",\"testing\":" << snapshot.testing_latency_ms << "}";
+	output << ",\"phases\":{";
+	if (xcs_profiler::enabled)
+	{
+		for(unsigned long p=0; p<xcs_profiler::NO_PHASES; p++)
+		{
+			output << ((p>0) ? "," : "") << "\"" << xcs_profiler::phase_name((xcs_profiler::t_phase) p) << "\":{";
+			output << "\"calls\":" << snapshot.phase_calls[p];
+			output << ",\"self_s\":" << snapshot.phase_self_ns[p]*1e-9;
+			output << ",\"inclusive_s\":" << snapshot.phase_inclusive_ns[p]*1e-9 << "}";
+		}
+	}
+	output << "}}" << endl;
+}
+
+/*!
+ * the request, if any, is read with a short timeout, so that clients that send nothing are
+ * answered as well; the answer is written without SIGPIPE, since clients may leave early
+ */
+void
+xcs_metrics::serve()
+{
+	while (!flag_stop.load())
+	{
+		struct pollfd	listening = {socket_fd, POLLIN, 0};
+
+		if (poll(&listening, 1, 100)<=0)
+			continue;
+
+		int	client = accept(socket_fd, NULL, NULL);
+
+		if (client==-1)
+			continue;
+
+		struct pollfd	request = {client, POLLIN, 0};
+		char			buffer[1024];
+		ssize_t			no_read = 0;
+
+		if (poll(&request, 1, 100)>0)
+			no_read = recv(client, buffer, sizeof(buffer), 0);
+
+		t_snapshot		snapshot;
+		ostringstream	body;
+		string			answer;
+
+		read(snapshot);
+		print(body, snapshot);
+
+		if ((no_read>=4) && (strncmp(buffer, "GET ", 4)==0))
+		{
+			ostringstream	http;
+
+			http << "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nContent-Length: " << body.str().size() << "\r\nConnection: close\r\n\r\n";
+			answer = http.str()+body.str();
+		} else {
+			answer = body.str();
+		}
+
+		for(size_t sent=0; sent<answer.size(); )
+		{
+			ssize_t	no_sent = send(client, answer.data()+sent, answer.size()-sent, MSG_NOSIGNAL);
+
+			if (no_sent<=0)
+				break;
+			sent += no_sent;
+		}
+		close(client);
+	}
+}
@@ -0,0 +1,145 @@
+/*!
+ * \file xcs_perf_counters.cpp
+ *
+ * \brief implements the hardware performance counters
+ *
+ */
+
+#include <cstring>
+#include <cerrno>
+#include "xcs_perf_counters.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+xcs_perf_counters::xcs_perf_counters() : no_open(0), why("not opened")
+{
+	for(unsigned long event=0; event<NO_EVENTS; event++)
+	{
+		fd[event] = -1;
+		position[event] = 0;
+	}
+}
+
+string
+xcs_perf_counters::event_name(const t_event event)
+{
+	switch (event)
+	{
+		case EVENT_CYCLES:			return "cycles";
+		case EVENT_INSTRUCTIONS:	return "instructions";
+		case EVENT_L1D_MISSES:		return "L1D misses";
+		case EVENT_LLC_MISSES:		return "LLC misses";
+		case EVENT_BRANCH_MISSES:	return "branch misses";
+		default:					return "unknown";
+	}
+}
+
+#ifdef __linux__
+/*!
+ * the group leader (cycles) is opened disabled, the other events join its group and, once all of
+ * them are open, the whole group is reset and enabled at once
+ */
+bool
+xcs_perf_counters::open()
+{
+	close();
+
+	const uint32_t	type[NO_EVENTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+	const uint64_t	config[NO_EVENTS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES};
+
+	why = "";
+	for(unsigned long event=0; event<NO_EVENTS; event++)
+	{
+		struct perf_event_attr	attr;
+
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type[event];
+		attr.config = config[event];
+		attr.disabled = (event==EVENT_CYCLES);
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+
+		fd[event] = syscall(__NR_perf_event_open, &attr, 0, -1, fd[EVENT_CYCLES], 0);
+		if (fd[event]==-1)
+		{
+			why += ((why=="") ? "" : ", ") + event_name((t_event) event) + ": " + strerror(errno);
+			//! without the leader there is no group
+			if (event==EVENT_CYCLES)
+				return false;
+		} else {
+			position[event] = no_open++;
+		}
+	}
+
+	ioctl(fd[EVENT_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(fd[EVENT_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	return true;
+}
+
+void
+xcs_perf_counters::close()
+{
+	for(unsigned long event=NO_EVENTS; event-->0; )
+	{
+		if (fd[event]!=-1)
+			::close(fd[event]);
+		fd[event] = -1;
+	}
+	no_open = 0;
+}
+
+//! with PERF_FORMAT_GROUP the leader returns the number of events followed by their values
+bool
+xcs_perf_counters::read(uint64_t values[NO_EVENTS]) const
+{
+	uint64_t	buffer[NO_EVENTS+1];
+
+	for(unsigned long event=0; event<NO_EVENTS; event++)
+		values[event] = 0;
+
+	if (!is_open())
+		return false;
+
+	if (::read(fd[EVENT_CYCLES], buffer, sizeof(buffer))<(ssize_t) ((no_open+1)*sizeof(uint64_t)))
+		return false;
+
+	for(unsigned long event=0; event<NO_EVENTS; event++)
+	{
+		if (fd[event]!=-1)
+			values[event] = buffer[1+position[event]];
+	}
+	return true;
+}
+#else
+bool
+xcs_perf_counters::open()
+{
+	why = "perf_event_open is available only on Linux";
+	return false;
+}
+
+void
+xcs_perf_counters::close()
+{
+}
+
+bool
+xcs_perf_counters::read(uint64_t values[NO_EVENTS]) const
+{
+	for(unsigned long event=0; event<NO_EVENTS; event++)
+		values[event] = 0;
+	return false;
+}
+#endif
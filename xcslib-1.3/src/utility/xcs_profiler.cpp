@@ -0,0 +1,170 @@
+/*!
+ * \file xcs_profiler.cpp
+ *
+ * \brief implements the profiler of the phases of a step
+ *
+ */
+
+#include <iomanip>
+#include "xcs_profiler.h"
+#include "xcs_utility.h"
+
+xcs_profiler::xcs_profiler()
+{
+	for(unsigned long phase=0; phase<NO_PHASES; phase++)
+		counted[phase] = false;
+	reset();
+}
+
+//! the phases to count are kept across experiments, only what has been measured is cleared
+void
+xcs_profiler::reset()
+{
+	active = NULL;
+	for(unsigned long phase=0; phase<NO_PHASES; phase++)
+	{
+		no_calls[phase] = 0;
+		iterations[phase] = 0;
+		self_ns[phase] = 0;
+		inclusive_ns[phase] = 0;
+		for(unsigned long event=0; event<xcs_perf_counters::NO_EVENTS; event++)
+			event_count[phase][event] = 0;
+	}
+}
+
+bool
+xcs_profiler::count_events(const string& phases)
+{
+	vector<string>	names = xcs_utility::split(phases, ",");
+
+	for(unsigned long p=0; p<NO_PHASES; p++)
+		counted[p] = false;
+	counters.close();
+
+	if (xcs_utility::trim(phases)=="off")
+		return true;
+
+	for(unsigned long n=0; n<names.size(); n++)
+	{
+		string	name = xcs_utility::trim(names[n]);
+		bool	found = false;
+
+		for(unsigned long p=0; p<NO_PHASES; p++)
+		{
+			if ((name=="all") || (name==phase_name((t_phase) p)))
+			{
+				counted[p] = true;
+				found = true;
+			}
+		}
+		if (!found)
+			xcs_utility::error(class_name(), "count_events", "phase '"+name+"' not recognized", 1);
+	}
+
+	return counters.open();
+}
+
+string
+xcs_profiler::counted_phases() const
+{
+	string	phases;
+
+	for(unsigned long p=0; p<NO_PHASES; p++)
+	{
+		if (counted[p])
+			phases += ((phases=="") ? "" : ", ") + phase_name((t_phase) p);
+	}
+	return (phases=="") ? "off" : phases;
+}
+
+string
+xcs_profiler::phase_name(const t_phase phase)
+{
+	switch (phase)
+	{
+		case PHASE_STEP:				return "step";
+		case PHASE_MATCH:				return "match";
+		case PHASE_COVERING:			return "covering";
+		case PHASE_PREDICTION_ARRAY:	return "prediction array";
+		case PHASE_ACTION_SET:			return "action set";
+		case PHASE_UPDATE:				return "update";
+		case PHASE_GA:					return "GA";
+		case PHASE_SUBSUMPTION:			return "subsumption";
+		case PHASE_DELETION:			return "deletion";
+		default:						return "unknown";
+	}
+}
+
+/*!
+ * times are in seconds, the average self time per call in nanoseconds, and the share is the
+ * fraction of the inclusive time of the whole step spent in the phase itself; iterations are
+ * reported only for the phases that count them
+ */
+void
+xcs_profiler::print(ostream& output) const
+{
+	double	step_ns = (inclusive_ns[PHASE_STEP]>0) ? inclusive_ns[PHASE_STEP] : 1;
+
+	output << "Phase\t\t\tCalls\tIterations\tSelf\tInclusive\tSelfPerCall\tShare" << endl;
+	for(unsigned long p=0; p<NO_PHASES; p++)
+	{
+		t_phase	phase = (t_phase) p;
+		string	name = phase_name(phase);
+
+		output << name << ((name.size()<8) ? "\t\t\t" : ((name.size()<16) ? "\t\t" : "\t"));
+		output << no_calls[phase] << "\t";
+		if (iterations[phase]>0)
+			output << iterations[phase] << "\t";
+		else
+			output << "-\t";
+		output << setprecision(4) << self_ns[phase]*1e-9 << "\t";
+		output << setprecision(4) << inclusive_ns[phase]*1e-9 << "\t";
+		output << setprecision(4) << ((no_calls[phase]>0) ? double(self_ns[phase])/no_calls[phase] : 0.0) << "\t";
+		output << setprecision(3) << 100.0*self_ns[phase]/step_ns << "%" << endl;
+	}
+
+	if (counted_phases()=="off")
+		return;
+
+	output << endl;
+	if (!counters.is_open())
+	{
+		output << "Hardware counters not available (" << counters.reason() << ")" << endl;
+		return;
+	}
+	print_events(output);
+}
+
+/*!
+ * events are inclusive, IPC is the number of instructions per cycle, and the events that the
+ * processor does not count are reported as -
+ */
+void
+xcs_profiler::print_events(ostream& output) const
+{
+	output << "Phase\t\t\tCycles\tInstructions\tIPC\tL1DMisses\tLLCMisses\tBranchMisses\tCyclesPerCall" << endl;
+	for(unsigned long p=0; p<NO_PHASES; p++)
+	{
+		if (!counted[p])
+			continue;
+
+		t_phase	phase = (t_phase) p;
+		string	name = phase_name(phase);
+
+		output << name << ((name.size()<8) ? "\t\t\t" : ((name.size()<16) ? "\t\t" : "\t"));
+		for(unsigned long e=0; e<xcs_perf_counters::NO_EVENTS; e++)
+		{
+			if (counters.available((xcs_perf_counters::t_event) e))
+				output << event_count[phase][e] << "\t";
+			else
+				output << "-\t";
+			if ((e==xcs_perf_counters::EVENT_INSTRUCTIONS) && counters.available(xcs_perf_counters::EVENT_INSTRUCTIONS))
+				output << setprecision(3) << ((event_count[phase][xcs_perf_counters::EVENT_CYCLES]>0) ? double(event_count[phase][e])/event_count[phase][xcs_perf_counters::EVENT_CYCLES] : 0.0) << "\t";
+			else if (e==xcs_perf_counters::EVENT_INSTRUCTIONS)
+				output << "-\t";
+		}
+		output << setprecision(4) << ((no_calls[phase]>0) ? double(event_count[phase][xcs_perf_counters::EVENT_CYCLES])/no_calls[phase] : 0.0) << endl;
+	}
+	if (counters.reason()!="")
+		output << "Events not available (" << counters.reason() << ")" << endl;
+}
@@ -8,11 +8,12 @@
 using namespace std;
 
 //! \var unsigned long xcs_random::seed is seed for random number generator.
-unsigned long	xcs_random::seed = 0;
+thread_local unsigned long	xcs_random::seed = 0;
 std::random_device xcs_random::rd;
-std::mt19937_64 xcs_random::generator;
-std::uniform_real_distribution<> xcs_random::uniform_distribution{0.0,1.0};
-std::normal_distribution<> xcs_random::normal_distribution;
+thread_local std::mt19937_64 xcs_random::generator;
+thread_local std::uniform_real_distribution<> xcs_random::uniform_distribution{0.0,1.0};
+thread_local std::normal_distribution<> xcs_random::normal_distribution;
+thread_local unsigned long long xcs_random::no_draws = 0;
 const std::vector<std::string> xcs_random::configuration_parameters = {"seed"};
 
 xcs_random::xcs_random()
@@ -64,6 +65,7 @@ xcs_random::set_seed(xcs_configuration_manager& xcs_config)
 double 
 xcs_random::random()
 {
+	no_draws++;
 	return (double) uniform_distribution(generator);
 }
 
@@ -72,6 +74,7 @@ xcs_random::set_seed(long new_seed)
 {
 	xcs_random::seed = new_seed;
  	generator.seed(xcs_random::seed);	
+	no_draws = 0;
 }
 
 /*! 
@@ -85,6 +88,18 @@ xcs_random::dice(const unsigned int limit)
 	return ((unsigned int)((xcs_random::random()*float(limit))));
 }
 
+/*! 
+ * \fn unsigned long long xcs_random::bits()
+ *
+ * \brief generate 64 random bits; it is used to fill packed binary inputs one word at a time.
+ */
+unsigned long long
+xcs_random::bits()
+{
+	no_draws++;
+	return (unsigned long long) generator();
+}
+
 /*!
  * \fn double nrandom()
  *
@@ -26,6 +26,24 @@ xcs_statistics::xcs_statistics()
 	reset();
 }
 
+void
+xcs_statistics::write_columns(ostream& output) const
+{
+	output << average_prediction << "\t";
+	output << average_fitness << "\t";
+	output << average_error << "\t";
+	output << average_actionset_size << "\t";
+	output << average_experience << "\t";
+	output << average_numerosity << "\t";
+	output << average_time_stamp << "\t";
+	output << system_error << "\t";
+
+	output << no_macroclassifiers << "\t";
+	output << no_ga << "\t";
+	output << no_cover << "\t";
+	output << no_subsumption << "\t";
+}
+
 ostream& 
 operator<<(ostream& output, const xcs_statistics& stats)
 {
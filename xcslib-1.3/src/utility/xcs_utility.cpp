@@ -165,6 +165,21 @@ std::vector<std::string> xcs_utility::split(std::string s, std::string delimiter
     return result;
 }
 
+/*!
+ * short strings are kept inside the object (small string optimization), longer ones take a heap
+ * block of capacity+1 bytes; the allocator overhead is not counted
+ */
+unsigned long
+xcs_utility::heap_size(const string& str)
+{
+	const char	*begin = (const char*) &str;
+	const char	*end = begin + sizeof(str);
+
+	if ((str.data()>=begin) && (str.data()<end))
+		return 0;
+	return str.capacity()+1;
+}
+
 string 
 xcs_utility::remove_comment(string const& source, string comment)
 {
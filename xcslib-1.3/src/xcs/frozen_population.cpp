@@ -0,0 +1,327 @@
+/*!
+ * \file frozen_population.cpp
+ *
+ * \brief implements the compilation of a static population into a decision structure
+ *
+ */
+
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <algorithm>
+#include "xcs_utility.h"
+#include "frozen_population.h"
+
+/*!
+ * \class frozen_population_builder
+ * \brief builds the decision diagram of a frozen population
+ *
+ * the diagram is built top-down: the classifiers that can still match on the current path are
+ * split on the next input they specify; the subproblems (i.e., the first input not yet tested and
+ * the set of classifiers) and the nodes are memoized, thus equal subproblems share the same node.
+ * The subproblems are identified by two independent 64 bit hashes of their set rather than by a
+ * copy of it, and the build stops as soon as the diagram exceeds max_nodes or the memory taken by
+ * the diagram, the leaves, and the tables exceeds max_bytes
+ */
+class frozen_population_builder
+{
+public:
+	frozen_population_builder(const vector<string>& conditions, const vector<unsigned long>& actions, const vector<double>& predictions, const vector<double>& fitness, const unsigned long no_actions, vector<double>& leaf_payoff, vector<bool>& leaf_matched) :
+		conditions(conditions), actions(actions), predictions(predictions), fitness(fitness), no_actions(no_actions), leaf_payoff(leaf_payoff), leaf_matched(leaf_matched), flag_overflow(false) {};
+
+	//! builds the diagram for the classifiers in set starting from input; the result is meaningless once overflow() is true
+	uint32_t build(unsigned long input, const vector<uint32_t>& set, vector<frozen_population::t_node>& nodes);
+
+	//! true if the diagram exceeded max_nodes or max_bytes
+	bool overflow() const { return flag_overflow; };
+
+private:
+	//! hashes of a subproblem
+	typedef pair<uint64_t, uint64_t>	t_key;
+
+	//! the first hash is already uniform, thus it is used as the bucket
+	struct t_key_hash {
+		size_t operator()(const t_key& key) const { return key.first; };
+	};
+
+	//! approximate number of bytes taken by an entry of the tables, including the overhead of the container
+	static const unsigned long entry_bytes = 64;
+
+	const vector<string>&			conditions;
+	const vector<unsigned long>&	actions;
+	const vector<double>&			predictions;
+	const vector<double>&			fitness;
+	unsigned long					no_actions;
+	vector<double>&					leaf_payoff;
+	vector<bool>&					leaf_matched;
+	bool							flag_overflow;
+
+	unordered_map<t_key, uint32_t, t_key_hash>						leaves;		//! leaf of each set of classifiers
+	unordered_map<t_key, uint32_t, t_key_hash>						solved;		//! node of each subproblem
+	map<tuple<unsigned long, uint32_t, uint32_t>, uint32_t>			unique;		//! node of each input and children
+
+	//! returns the hashes of the subproblem that starts from input with the classifiers in set
+	static t_key key(const unsigned long input, const vector<uint32_t>& set);
+
+	//! returns the leaf whose classifiers are those in set
+	uint32_t leaf(const vector<uint32_t>& set);
+
+	//! sets flag_overflow if the diagram with the given number of nodes is too large
+	void check_size(const unsigned long no_nodes);
+};
+
+//! FNV-1a and a multiply-xorshift mix of the same values; both must collide for two subproblems to be confused
+frozen_population_builder::t_key
+frozen_population_builder::key(const unsigned long input, const vector<uint32_t>& set)
+{
+	uint64_t	first = 14695981039346656037ULL;
+	uint64_t	second = input+set.size();
+
+	first = (first ^ input) * 1099511628211ULL;
+	for(vector<uint32_t>::const_iterator cl=set.begin(); cl!=set.end(); cl++)
+	{
+		first = (first ^ *cl) * 1099511628211ULL;
+
+		second = (second ^ *cl) * 0x9E3779B97F4A7C15ULL;
+		second ^= second >> 29;
+	}
+	return t_key(first, second);
+}
+
+void
+frozen_population_builder::check_size(const unsigned long no_nodes)
+{
+	unsigned long	no_bytes = no_nodes*sizeof(frozen_population::t_node);
+
+	no_bytes += leaves.size()*no_actions*(sizeof(double)+1);
+	no_bytes += (leaves.size()+solved.size()+unique.size())*entry_bytes;
+
+	if ((no_nodes>frozen_population::max_nodes) || (no_bytes>frozen_population::max_bytes))
+		flag_overflow = true;
+}
+
+uint32_t
+frozen_population_builder::leaf(const vector<uint32_t>& set)
+{
+	t_key	set_key = key(0, set);
+	unordered_map<t_key, uint32_t, t_key_hash>::const_iterator	found = leaves.find(set_key);
+
+	if (found!=leaves.end())
+		return found->second;
+
+	uint32_t		index = leaves.size();
+	vector<double>	fitness_sum(no_actions, 0.0);
+
+	leaf_payoff.resize((index+1)*no_actions, 0.0);
+	leaf_matched.resize((index+1)*no_actions, false);
+
+	for(vector<uint32_t>::const_iterator cl=set.begin(); cl!=set.end(); cl++)
+	{
+		leaf_payoff[index*no_actions+actions[*cl]] += predictions[*cl]*fitness[*cl];
+		fitness_sum[actions[*cl]] += fitness[*cl];
+		leaf_matched[index*no_actions+actions[*cl]] = true;
+	}
+
+	for(unsigned long act=0; act<no_actions; act++)
+	{
+		if (fitness_sum[act]>0)
+			leaf_payoff[index*no_actions+act] /= fitness_sum[act];
+	}
+
+	leaves[set_key] = index | frozen_population::leaf_flag;
+	return index | frozen_population::leaf_flag;
+}
+
+uint32_t
+frozen_population_builder::build(unsigned long input, const vector<uint32_t>& set, vector<frozen_population::t_node>& nodes)
+{
+	unsigned long	no_inputs = conditions.empty() ? 0 : conditions[0].size();
+
+	if (flag_overflow)
+		return 0;
+
+	//! the inputs that no classifier in the set specifies are skipped
+	for(bool dont_care=true; dont_care && (input<no_inputs); )
+	{
+		for(vector<uint32_t>::const_iterator cl=set.begin(); dont_care && (cl!=set.end()); cl++)
+		{
+			dont_care = (conditions[*cl][input]=='#');
+		}
+		if (dont_care)
+			input++;
+	}
+
+	if (input==no_inputs)
+		return leaf(set);
+
+	t_key	subproblem = key(input, set);
+	unordered_map<t_key, uint32_t, t_key_hash>::const_iterator	found = solved.find(subproblem);
+
+	if (found!=solved.end())
+		return found->second;
+
+	uint32_t	low;
+	uint32_t	high;
+
+	//! the subsets are freed before the node is added
+	{
+		vector<uint32_t>	subset[2];
+
+		for(vector<uint32_t>::const_iterator cl=set.begin(); cl!=set.end(); cl++)
+		{
+			if (conditions[*cl][input]!='1')
+				subset[0].push_back(*cl);
+			if (conditions[*cl][input]!='0')
+				subset[1].push_back(*cl);
+		}
+
+		low = build(input+1, subset[0], nodes);
+		high = build(input+1, subset[1], nodes);
+	}
+
+	if (flag_overflow)
+		return 0;
+
+	uint32_t	node;
+
+	if (low==high)
+	{
+		node = low;
+	} else {
+		tuple<unsigned long, uint32_t, uint32_t>	children(input, low, high);
+		map<tuple<unsigned long, uint32_t, uint32_t>, uint32_t>::const_iterator	same = unique.find(children);
+
+		if (same!=unique.end())
+		{
+			node = same->second;
+		} else {
+			check_size(nodes.size()+1);
+			if (flag_overflow)
+				return 0;
+
+			node = nodes.size();
+			nodes.resize(nodes.size()+1);
+			nodes.back().input = input;
+			nodes.back().child[0] = low;
+			nodes.back().child[1] = high;
+			unique[children] = node;
+		}
+	}
+
+	solved[subproblem] = node;
+	return node;
+}
+
+bool
+frozen_population::build(const vector<string>& conditions, const vector<unsigned long>& actions, const vector<double>& predictions, const vector<double>& fitness, const unsigned long no_actions, const bool flag_table)
+{
+	diagram.clear();
+	leaf_payoff.clear();
+	leaf_matched.clear();
+	dense_table.clear();
+
+	if (conditions.empty())
+		return false;
+
+	this->no_inputs = conditions[0].size();
+	this->no_actions = no_actions;
+
+	vector<uint32_t>	population(conditions.size());
+
+	for(uint32_t cl=0; cl<conditions.size(); cl++)
+	{
+		if (conditions[cl].size()!=no_inputs)
+		{
+			xcs_utility::error(class_name(), "build", "condition '" + conditions[cl] + "' has the wrong size", 1);
+		}
+		if (actions[cl]>=no_actions)
+		{
+			xcs_utility::error(class_name(), "build", "action not valid", 1);
+		}
+		population[cl] = cl;
+	}
+
+	frozen_population_builder	builder(conditions, actions, predictions, fitness, no_actions, leaf_payoff, leaf_matched);
+
+	root = builder.build(0, population, diagram);
+
+	//! the memory of a diagram that is too large is released at once
+	if (builder.overflow())
+	{
+		vector<t_node>().swap(diagram);
+		vector<double>().swap(leaf_payoff);
+		vector<bool>().swap(leaf_matched);
+		root = 0;
+		return false;
+	}
+
+	if (flag_table && (no_inputs<=max_table_bits))
+	{
+		dense_table.resize(1UL << no_inputs);
+
+		for(unsigned long configuration=0; configuration<dense_table.size(); configuration++)
+		{
+			uint32_t	node = root;
+
+			while (!(node & leaf_flag))
+			{
+				node = diagram[node].child[(configuration >> (no_inputs-1-diagram[node].input)) & 1];
+			}
+			dense_table[configuration] = node & ~leaf_flag;
+		}
+	}
+	return true;
+}
+
+unsigned long
+frozen_population::leaf(const string& input) const
+{
+	assert(input.size()==no_inputs);
+
+	if (!dense_table.empty())
+	{
+		unsigned long	configuration = 0;
+
+		for(unsigned long i=0; i<no_inputs; i++)
+		{
+			configuration = (configuration << 1) | (input[i]=='1');
+		}
+		return dense_table[configuration];
+	}
+
+	uint32_t	node = root;
+
+	while (!(node & leaf_flag))
+	{
+		node = diagram[node].child[input[diagram[node].input]=='1'];
+	}
+	return node & ~leaf_flag;
+}
+
+void
+frozen_population::predict(const vector<t_state>& inputs, vector<double>& prediction, vector<bool>& matched) const
+{
+	if (prediction.size()!=inputs.size()*no_actions)
+		prediction.resize(inputs.size()*no_actions);
+	if (matched.size()!=inputs.size()*no_actions)
+		matched.resize(inputs.size()*no_actions);
+
+	for(unsigned long i=0; i<inputs.size(); i++)
+	{
+		unsigned long	index = leaf(inputs[i].string_reference());
+
+		for(unsigned long act=0; act<no_actions; act++)
+		{
+			prediction[i*no_actions+act] = leaf_payoff[index*no_actions+act];
+			matched[i*no_actions+act] = leaf_matched[index*no_actions+act];
+		}
+	}
+}
+
+void
+frozen_population::print(ostream& output) const
+{
+	output << no_inputs << " inputs, " << nodes() << " nodes, " << leaves() << " leaves";
+	if (table())
+		output << ", dense table of " << dense_table.size() << " entries";
+}
@@ -0,0 +1,36 @@
+/*!
+ * \file population_snapshot.cpp
+ *
+ * \brief implements the read-only copy of a population
+ *
+ */
+
+#include <algorithm>
+#include "xcs_utility.h"
+#include "population_snapshot.h"
+
+void
+population_snapshot::build(const vector<string>& conditions, const vector<unsigned long>& actions, const vector<double>& predictions, const vector<double>& fitness, const unsigned long no_actions)
+{
+	this->no_actions = no_actions;
+	this->conditions.resize(conditions.size());
+	for(unsigned long cl=0; cl<conditions.size(); cl++)
+	{
+		this->conditions[cl].set_string_value(conditions[cl]);
+	}
+	this->actions_taken = actions;
+	this->predictions = predictions;
+	this->fitness = fitness;
+}
+
+void
+population_snapshot::predict(const vector<t_state>& inputs, vector<double>& prediction, vector<bool>& matched) const
+{
+	predict_batch(inputs, no_actions, [this](const string& input, const auto& add) {
+		for(unsigned long cl=0; cl<conditions.size(); cl++)
+		{
+			if (conditions[cl].match(input))
+				add(actions_taken[cl], predictions[cl], fitness[cl]);
+		}
+	}, prediction, matched);
+}
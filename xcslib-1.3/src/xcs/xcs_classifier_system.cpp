@@ -11,11 +11,13 @@
 
 using namespace std;
 
-const std::vector<std::string> xcs_classifier_system::configuration_parameters = {"population size", "epsilon zero", "theta GA", "initial population", "crossover probability", "mutation probability", "learning rate", "discount factor", "discovery component", "vi", "alpha", "prediction init", "error init", "fitness init", "set size init", "exploration strategy", "deletion strategy", "theta delete", "theta GA sub", "theta AS sub", "GA subsumption", "GAA subsumption", "AS subsumption", "update during test", "update error first", "tournament selection", "tournament size", "gradient descent", "niche queue max size"};
+const std::vector<std::string> xcs_classifier_system::configuration_parameters = {"population size", "epsilon zero", "theta GA", "initial population", "crossover probability", "mutation probability", "learning rate", "discount factor", "discovery component", "vi", "alpha", "prediction init", "error init", "fitness init", "set size init", "exploration strategy", "deletion strategy", "theta delete", "theta GA sub", "theta AS sub", "GA subsumption", "GAA subsumption", "AS subsumption", "update during test", "update error first", "tournament selection", "tournament size", "gradient descent", "niche queue max size", "hardware counters"};
 
 xcs_classifier_system::xcs_classifier_system(xcs_configuration_manager& xcs_config, t_environment *environment)
 {
 	this->environment = environment;
+	last_action = 0;
+	last_perform_draws = 0;
 
 	//! look for the init section in the configuration file
 	if (!xcs_config.exist(tag_name()))
@@ -37,6 +39,9 @@ xcs_classifier_system::xcs_classifier_system(xcs_configuration_manager& xcs_conf
 
 	//! create the prediction array
 	create_prediction_array();
+
+	//! [P] is empty
+	init_population_sums();
 	
 	//! check subsumption settings
 	t_condition	cond;
@@ -158,6 +163,16 @@ void xcs_classifier_system::set_parameters(xcs_configuration_manager &xcs_config
     // string str_use_gd = (string)xcs_config.Value(tag_name(), "gradient descent", "off");
 	xcs_utility::set_flag(xcs_config.Value(tag_name(), "gradient descent", "off"), flag_use_gradient_descent);
 
+	//! phases measured with the hardware counters, only when the profiler is compiled
+	string str_counters = (string)xcs_config.Value(tag_name(), "hardware counters", "off");
+	if (str_counters!="off")
+	{
+		if (!xcs_profiler::enabled)
+			xcs_utility::warning(class_name(), "set_parameters", "hardware counters require a build with -D__PROFILE__, ignored");
+		else if (!profiler.count_events(str_counters))
+			xcs_utility::warning(class_name(), "set_parameters", "hardware counters not available ("+profiler.counters_status()+")");
+	}
+
 	//! constant parameters 
 	delta_del = 0.1;
     flag_cover_average_init = false;
@@ -242,6 +257,7 @@ void xcs_classifier_system::print_parameters(ostream& OUTPUT) const
 	OUTPUT << "\t" << "tournament size = " << tournament_size << endl;
 
 	OUTPUT << "\t" << "gradient descent = " << (flag_use_gradient_descent?"on":"off") << endl;
+	OUTPUT << "\t" << "hardware counters = " << profiler.counted_phases() << endl;
 	OUTPUT << "</" << tag_name() << ">" << endl;
 }
 
@@ -341,6 +357,7 @@ xcs_classifier_system::insert_classifier(const t_classifier& new_cl)
 	/// keep a sorted index of classifiers
 	t_classifier *clp = new t_classifier;
 	*clp = new_cl;
+	memory.allocate(clp->footprint());
 
 	clp->time_stamp = total_steps;
 	clp->experience = 0;
@@ -356,10 +373,14 @@ xcs_classifier_system::insert_classifier(const t_classifier& new_cl)
 			clp->time_stamp = total_steps;
 
 			population.insert(pp,clp);
+			account(*clp, 1);
 			macro_size++;
+			population_size++;
+			memory.population(macro_size, population_size);
 		}
 		else {
-			(**pp).numerosity++;
+			increment_numerosity(**pp);
+			memory.release(clp->footprint());
 			delete clp;
 		}
 	} else {
@@ -368,15 +389,19 @@ xcs_classifier_system::insert_classifier(const t_classifier& new_cl)
 		clp->time_stamp = total_steps;
 
 		population.insert(pp,clp);
+		account(*clp, 1);
 		macro_size++;
+		population_size++;
+		memory.population(macro_size, population_size);
 	}
-	population_size++;
 }
 
 //! build [M]
 unsigned long	
 xcs_classifier_system::match(const t_state& detectors)
 {
+	XCS_PROFILE(profiler, PHASE_MATCH);
+
 	t_set_iterator			pp;		/// iterator for visiting [P]
 	unsigned long			match_set_size = 0;		/// number of micro classifiers in [M]
 
@@ -413,6 +438,36 @@ xcs_classifier_system::match(const t_state& detectors)
 	return match_set_size;
 }
 
+void
+xcs_classifier_system::match(const vector<t_state>& detectors, const vector<bool>& running, vector<t_classifier_set>& match_sets)
+{
+	XCS_PROFILE(profiler, PHASE_MATCH);
+
+	t_set_iterator			pp;		/// iterator for visiting [P]
+	unsigned long			no_inputs = detectors.size();
+
+	batch_strings.resize(no_inputs);
+	match_sets.resize(no_inputs);
+
+	for(unsigned long i=0; i<no_inputs; i++)
+	{
+		batch_strings[i] = detectors[i].string_value();
+		match_sets[i].clear();
+	}
+
+	//! every classifier is read once and tested against all the inputs
+	for(pp=population.begin();pp!=population.end();pp++)
+	{
+		for(unsigned long i=0; i<no_inputs; i++)
+		{
+			if (running[i] && (**pp).condition.match(batch_strings[i]))
+			{
+				match_sets[i].push_back(*pp);
+			}
+		}
+	}
+}
+
 //! perform covering on [M], only if needed
 bool
 xcs_classifier_system::perform_covering(t_classifier_set &match_set, const t_state& detectors)
@@ -454,6 +509,8 @@ xcs_classifier_system::perform_standard_covering(t_classifier_set &match_set, co
 
 		//! delete another classifier from [P] if necessary
 		delete_classifier();
+
+		stats.no_cover++;
 		
 		//! signal that a covering operation took place
 		return true;
@@ -498,6 +555,8 @@ xcs_classifier_system::need_standard_covering(t_classifier_set &match_set, const
 void	
 xcs_classifier_system::build_prediction_array()
 {
+	XCS_PROFILE(profiler, PHASE_PREDICTION_ARRAY);
+
 	t_set_iterator					mp;
 	vector<t_system_prediction>::iterator		pr;	
 	t_system_prediction				prediction;
@@ -623,6 +682,8 @@ xcs_classifier_system::select_random_action(t_action& action) const
 void
 xcs_classifier_system::update_set(const double P, t_classifier_set &action_set)
 {
+	XCS_PROFILE(profiler, PHASE_UPDATE);
+
 	t_set_iterator	clp;
 	double		set_size = 0;
 	double		fitness_sum = 0;	//! sum of classifier fitness in [A]
@@ -631,6 +692,7 @@ xcs_classifier_system::update_set(const double P, t_classifier_set &action_set)
 	//! estimate the action set size
 	for(clp=action_set.begin(); clp != action_set.end(); clp++)
 	{
+		account(**clp, -1);
 		(**clp).experience++;
 		set_size += (**clp).numerosity;
 		fitness_sum += (**clp).fitness;	//! sums up classifier fitness for gradient descent
@@ -686,6 +748,7 @@ xcs_classifier_system::update_set(const double P, t_classifier_set &action_set)
 		} else {
 			(**clp).actionset_size += (set_size - (**clp).actionset_size)/(**clp).experience;
 		}
+		account(**clp, 1);
 	}
 
 	//! update fitness
@@ -734,7 +797,9 @@ xcs_classifier_system::update_fitness(t_classifier_set &action_set)
 
 	for(as = action_set.begin(), rp=raw_accuracy.begin(); as!=action_set.end(); as++,rp++)
 	{
+		population_sums.fitness -= (**as).fitness;
 		(**as).fitness += learning_rate*((*rp)/accuracy_sum - (**as).fitness);
+		population_sums.fitness += (**as).fitness;
 	}
 
 }
@@ -742,6 +807,8 @@ xcs_classifier_system::update_fitness(t_classifier_set &action_set)
 bool
 xcs_classifier_system::subsume(const t_classifier &first, const t_classifier &second)
 {
+	XCS_PROFILE(profiler, PHASE_SUBSUMPTION);
+
 	bool	result;
 	
 	result = (classifier_could_subsume(first, epsilon_zero, theta_sub)) && (first.subsume(second));
@@ -800,12 +867,88 @@ void xcs_classifier_system::update_timestamp(t_classifier_set &action_set)
 	//! set the time stamp of classifiers in [A]
 	for(t_set_iterator as=action_set.begin(); as!=action_set.end(); as++)
 	{
+		population_sums.time_stamp += (**as).numerosity*(double(total_steps)-(**as).time_stamp);
 		(**as).time_stamp = total_steps;
 	}
 }
+void
+xcs_classifier_system::account(const t_classifier& classifier, const double sign)
+{
+	double	weight = sign*classifier.numerosity;
+
+	population_sums.prediction += weight*classifier.prediction;
+	population_sums.fitness += sign*classifier.fitness;
+	population_sums.error += weight*classifier.error;
+	population_sums.actionset_size += weight*classifier.actionset_size;
+	population_sums.experience += weight*classifier.experience;
+	population_sums.time_stamp += weight*classifier.time_stamp;
+}
+
+void
+xcs_classifier_system::init_population_sums()
+{
+	population_sums.prediction = 0;
+	population_sums.fitness = 0;
+	population_sums.error = 0;
+	population_sums.actionset_size = 0;
+	population_sums.experience = 0;
+	population_sums.time_stamp = 0;
+
+	for(t_set_const_iterator pp=population.begin(); pp!=population.end(); pp++)
+	{
+		account(**pp, 1);
+	}
+}
+
+//! [P] grows by one micro classifier, thus its peak size is sampled as in insert_classifier
+void
+xcs_classifier_system::increment_numerosity(t_classifier& classifier)
+{
+	account(classifier, -1);
+	classifier.numerosity++;
+	account(classifier, 1);
+
+	population_size++;
+	memory.population(macro_size, population_size);
+}
+
+/*!
+ * the averages over [P] are computed in constant time from the sums that are updated whenever a
+ * classifier enters or leaves [P], or its parameters or numerosity change; prediction, error,
+ * action set size, experience, and time stamp are averaged over the micro classifiers, fitness
+ * and numerosity over the macro classifiers
+ */
+xcs_statistics
+xcs_classifier_system::statistics() const
+{
+	xcs_statistics	result = stats;
+
+	if (population_size>0)
+	{
+		result.average_prediction = population_sums.prediction/population_size;
+		result.average_error = population_sums.error/population_size;
+		result.average_actionset_size = population_sums.actionset_size/population_size;
+		result.average_experience = population_sums.experience/population_size;
+		result.average_time_stamp = population_sums.time_stamp/population_size;
+	}
+
+	if (!population.empty())
+	{
+		result.average_fitness = population_sums.fitness/population.size();
+		result.average_numerosity = double(population_size)/population.size();
+	}
+
+	result.no_macroclassifiers = population.size();
+	result.system_error = system_error;
+	return result;
+}
+
 void
 xcs_classifier_system::genetic_algorithm(t_classifier_set &action_set, const t_state& detectors, bool flag_condensation)
 {
+	XCS_PROFILE(profiler, PHASE_GA);
+	xcs_event_trace::span	trace_ga("GA", "xcs", "step", total_time);
+
 	t_set_iterator 	parent1;
 	t_set_iterator	parent2;
 
@@ -871,12 +1014,10 @@ xcs_classifier_system::genetic_algorithm(t_classifier_set &action_set, const t_s
 		{
 			if (subsume(**parent1, offspring1))
 			{	//! parent1 subsumes offspring1
-				(**parent1).numerosity++;
-				population_size++;
+				increment_numerosity(**parent1);
 			} else if (subsume(**parent2, offspring1))
 			{	//! parent2 subsumes offspring1
-				(**parent2).numerosity++;
-				population_size++;
+				increment_numerosity(**parent2);
 			} else {
 				//! neither of the parent subsumes offspring1
 				if (!flag_gaa_subsumption)
@@ -890,8 +1031,7 @@ xcs_classifier_system::genetic_algorithm(t_classifier_set &action_set, const t_s
 					ga_a_subsume(action_set,offspring1,par);
 					if (par!=action_set.end())
 					{				
-						(**par).numerosity++;
-						population_size++;
+						increment_numerosity(**par);
 					} else {
 						insert_classifier(offspring1);
 					}
@@ -900,13 +1040,11 @@ xcs_classifier_system::genetic_algorithm(t_classifier_set &action_set, const t_s
 	
 			if (subsume(**parent1, offspring2))
 			{	//! parent1 subsumes offspring2
-				(**parent1).numerosity++;
-				population_size++;
+				increment_numerosity(**parent1);
 			}
 			else if (subsume(**parent2, offspring2))
 			{	//! parent2 subsumes offspring2
-				(**parent2).numerosity++;
-				population_size++;
+				increment_numerosity(**parent2);
 			} else {
 				//! neither of the parent subsumes offspring1
 				if (!flag_gaa_subsumption)
@@ -920,8 +1058,7 @@ xcs_classifier_system::genetic_algorithm(t_classifier_set &action_set, const t_s
 					ga_a_subsume(action_set,offspring2,par);
 					if (par!=action_set.end())
 					{				
-						(**par).numerosity++;
-						population_size++;
+						increment_numerosity(**par);
 					} else {
 						insert_classifier(offspring2);
 					}
@@ -940,12 +1077,10 @@ xcs_classifier_system::genetic_algorithm(t_classifier_set &action_set, const t_s
 
 	} else {
 		// when in condensation
-		(**parent1).numerosity++;
-		population_size++;
+		increment_numerosity(**parent1);
 		delete_classifier();
 
-		(**parent2).numerosity++;
-		population_size++;
+		increment_numerosity(**parent2);
 		delete_classifier();
 	}
 }
@@ -953,11 +1088,8 @@ xcs_classifier_system::genetic_algorithm(t_classifier_set &action_set, const t_s
 void	
 xcs_classifier_system::step(const bool exploration_mode, const bool condensationMode)
 {
-	t_action	action;					//! selected action
-	unsigned long	match_set_size;		//! number of microclassifiers in [M]
-	//unsigned long	action_set_size;	//! number of microclassifiers in [A]
-	double		P;						//! value for prediction update, computed as r + gamma * max P(.) 
-	double		max_prediction;
+	XCS_PROFILE(profiler, PHASE_STEP);
+	xcs_event_trace::span	trace_step("step", "xcs", "step", total_time, xcs_event_trace::sample_step(total_time));
 
 	//! reads the current input
 	current_input = environment->state(); 
@@ -971,16 +1103,90 @@ xcs_classifier_system::step(const bool exploration_mode, const bool condensation
 
 	total_time++;
 
+	match(current_input);
+
+	step_matched(exploration_mode, condensationMode);
+}
+
+void
+xcs_classifier_system::step(vector_env& environments, const vector<bool>& running, const vector<bool>& exploration, const bool condensationMode)
+{
+	XCS_PROFILE(profiler, PHASE_STEP);
+	xcs_event_trace::span	trace_step("batch step", "xcs", "step", total_time, xcs_event_trace::sample_step(total_time));
+
+	t_environment	*single_environment = environment;	//! the environment used by the single step
+
+	assert(running.size()==environments.size());
+	assert(exploration.size()==environments.size());
+	assert(batch_match_sets.size()==environments.size());
+
+	//! reads the current inputs and matches them against [P]
+	environments.states(batch_inputs);
+	match(batch_inputs, running, batch_match_sets);
+
+	for(unsigned long i=0; i<environments.size(); i++)
+	{
+		if (!running[i])
+			continue;
+
+		//! the episode is swapped in 
+		environment = &environments[i];
+		current_input = batch_inputs[i];
+		match_set.swap(batch_match_sets[i]);
+		previous_action_set.swap(batch_previous_action_sets[i]);
+		previous_reward = batch_previous_reward[i];
+
+		if (exploration[i])
+		{
+			total_steps++;
+			total_learning_steps++;
+		} 
+
+		total_time++;
+
+		step_matched(exploration[i], condensationMode);
+
+		//! the episode is swapped out
+		previous_action_set.swap(batch_previous_action_sets[i]);
+		batch_previous_reward[i] = previous_reward;
+		batch_system_error[i] = system_error;
+		match_set.clear();
+		batch_match_sets[i].clear();
+	}
+
+	environment = single_environment;
+}
+
+void	
+xcs_classifier_system::step_matched(const bool exploration_mode, const bool condensationMode)
+{
+	t_action	action;					//! selected action
+	double		P;						//! value for prediction update, computed as r + gamma * max P(.) 
+	double		max_prediction;
+
 	/*! 
 	 * check if [M] needs covering,
 	 * if it does, it apply the selected covering strategy, i.e., standard as defined in Wilson 1995,
 	 * or action_based as defined in Butz and Wilson 2001
 	 */
 
-	do {
-		match_set_size = match(current_input);
+	{
+		XCS_PROFILE(profiler, PHASE_COVERING);
+
+		//! only the steps that actually cover are traced, as one burst
+		uint64_t		covering_start = xcs_event_trace::is_open() ? xcs_event_trace::now() : 0;
+		unsigned long	no_covering = 0;
+
+		while (perform_covering(match_set, current_input))
+		{
+			XCS_PROFILE_COUNT(profiler, PHASE_COVERING);
+			match(current_input);
+			no_covering++;
+		}
+
+		if (no_covering>0)
+			xcs_event_trace::complete("covering", "xcs", covering_start, "iterations", no_covering);
 	}
-   	while (perform_covering(match_set, current_input));
 
 	//! build the prediction array P(.)
 	build_prediction_array();
@@ -999,6 +1205,7 @@ xcs_classifier_system::step(const bool exploration_mode, const bool condensation
 
 	//! build [A]
 	build_action_set(action);
+	memory.sets(match_set.size(), action_set.size());
 
 #ifdef __DEBUG__
 	cout << "ACTION " << action << endl;
@@ -1006,7 +1213,11 @@ xcs_classifier_system::step(const bool exploration_mode, const bool condensation
 	//! store the current input before performing the selected action	
 	previous_input = environment->state();
 
+	unsigned long long	draws = xcs_random::draws();
+
 	environment->perform(action);
+	last_perform_draws = xcs_random::draws()-draws;
+	last_action = action.value();
 
 	//! if the environment is single step, the system error is collected
 	if (environment->single_step())
@@ -1092,10 +1303,33 @@ xcs_classifier_system::save_population(ostream& output)
 	}
 }
 
+/*!
+ * FNV-1a over the lines written by save_population, thus two populations have the same
+ * fingerprint when their files are identical
+ */
+uint64_t
+xcs_classifier_system::fingerprint() const
+{
+	uint64_t	value = 14695981039346656037ULL;
+
+	for(t_set_const_iterator pp=population.begin(); pp!=population.end(); pp++)
+	{
+		ostringstream	line;
+
+		line << (**pp) << endl;
+		for(const char c : line.str())
+		{
+			value ^= (unsigned char) c;
+			value *= 1099511628211ULL;
+		}
+	}
+	return value;
+}
+
 void	
 xcs_classifier_system::save_state(ostream& output) 
 {
-	output << stats << endl;
+	output << statistics() << endl;
 	output << total_steps << endl;
 	t_classifier::save_state(output);
 	output << macro_size << endl;
@@ -1123,12 +1357,16 @@ xcs_classifier_system::restore_state(istream& input)
 		if (!input.eof() && (input >> in_classifier))
 		{
 			t_classifier	*classifier = new t_classifier(in_classifier);
+			memory.allocate(classifier->footprint());
 			population.push_back(classifier);
 			population_size += classifier->numerosity;
 			macro_size++;
 		}
 	};
 	assert(macro_size==size);
+	memory.population(macro_size, population_size);
+
+	init_population_sums();
 }
 
 //! defines what has to be done when a new experiment begins
@@ -1147,6 +1385,7 @@ xcs_classifier_system::begin_experiment()
 
 	//! init the experiment statistics
 	stats.reset();
+	profiler.reset();
 	
 	//! [P] contains 0 macro/micro classifiers
 	population_size = 0;
@@ -1154,6 +1393,11 @@ xcs_classifier_system::begin_experiment()
 
 	//! init [P]
 	init_classifier_set();
+	init_population_sums();
+
+	//! the initial population is not counted as churn
+	memory.reset();
+	memory.population(macro_size, population_size);
 }
 
 
@@ -1186,6 +1430,52 @@ xcs_classifier_system::end_problem()
 	action_set.clear();
 }
 
+void
+xcs_classifier_system::begin_batch(const unsigned long size)
+{
+	begin_problem();
+
+	batch_match_sets.assign(size, t_classifier_set());
+	batch_previous_action_sets.assign(size, t_classifier_set());
+	batch_previous_reward.assign(size, 0);
+	batch_system_error.assign(size, 0);
+}
+
+void
+xcs_classifier_system::end_batch()
+{
+	end_problem();
+
+	batch_match_sets.clear();
+	batch_previous_action_sets.clear();
+}
+
+//! the classifier is removed from the sets of the episodes which are not currently swapped in
+void
+xcs_classifier_system::forget_classifier(t_classifier *classifier)
+{
+	vector<t_classifier_set>::iterator	set;
+	t_set_iterator				clp;
+
+	for(set=batch_match_sets.begin(); set!=batch_match_sets.end(); set++)
+	{
+		clp = find(set->begin(), set->end(), classifier);
+		if (clp!=set->end())
+		{
+			set->erase(clp);
+		}
+	}
+
+	for(set=batch_previous_action_sets.begin(); set!=batch_previous_action_sets.end(); set++)
+	{
+		clp = find(set->begin(), set->end(), classifier);
+		if (clp!=set->end())
+		{
+			set->erase(clp);
+		}
+	}
+}
+
 
 
 bool	
@@ -1242,6 +1532,7 @@ xcs_classifier_system::perform_nma_covering(t_classifier_set &match_set, const t
 			}
 		}
 		covered_some_actions = true;
+		stats.no_cover++;
 	}
 
 	return covered_some_actions;
@@ -1301,6 +1592,8 @@ xcs_classifier_system::init_classifier(t_classifier& classifier, bool average)
 void	
 xcs_classifier_system::build_action_set(const t_action& action)
 {
+	XCS_PROFILE(profiler, PHASE_ACTION_SET);
+
 	//! iterator in [M]
 	t_set_iterator 	mp;
 
@@ -1331,6 +1624,7 @@ xcs_classifier_system::clear_population()
 	//! delete all the classifiers in [P]
 	for(pp=population.begin(); pp!=population.end(); pp++)
 	{
+		memory.release((**pp).footprint());
 		delete *pp; 
 	}
 
@@ -1558,6 +1852,7 @@ xcs_classifier_system::erase_population()
 	t_set_iterator			pp;		//! iterator for visiting [P]
 	for(pp=population.begin(); pp!=population.end(); pp++)
 	{
+		memory.release((**pp).footprint());
 		delete (*pp);
 	}
 	population.clear();
@@ -1598,6 +1893,8 @@ xcs_classifier_system::as_subsume(t_set_iterator classifier, t_classifier_set &s
 			previous_action_set.erase(clp);
 		}
 
+		forget_classifier(*sp);
+
 
 		pp = lower_bound(population.begin(),population.end(),*sp,compare_cl);
 		if ((pp!=population.end()))
@@ -1612,8 +1909,12 @@ xcs_classifier_system::as_subsume(t_set_iterator classifier, t_classifier_set &s
 
 		macro_size--;
 
+		account(*most_general, -1);
+		account(**pp, -1);
                 most_general->numerosity += (*pp)->numerosity;
+		account(*most_general, 1);
 
+		memory.release((**pp).footprint());
 		delete *pp;
 		population.erase(pp);
 	}
@@ -1651,6 +1952,8 @@ const
 void	
 xcs_classifier_system::do_as_subsumption(t_classifier_set &set)
 {
+	XCS_PROFILE(profiler, PHASE_SUBSUMPTION);
+
 	/*! 
 	 * \brief check whether the condition type allow action set subsumption
 	 *
@@ -1727,10 +2030,10 @@ xcs_classifier_system::init_population_random()
 	check.start();
 	for(cl=0; cl<max_population_size; cl++)
 	{
-		t_classifier *classifier = new t_classifier();
-		classifier->random();
-		init_classifier(*classifier);
-		insert_classifier(*classifier);
+		t_classifier classifier;
+		classifier.random();
+		init_classifier(classifier);
+		insert_classifier(classifier);
 	}
 
 	check.stop();
@@ -1825,6 +2128,7 @@ xcs_classifier_system::init_population_load(string filename)
 
 			t_classifier	*classifier = new t_classifier(in_classifier);
 			classifier->time_stamp = total_steps;
+			memory.allocate(classifier->footprint());
 			population.push_back(classifier);
 			population_size += classifier->numerosity;
 			macro_size++;
@@ -1873,6 +2177,7 @@ xcs_classifier_system::init_population_solution(string filename)
 		classifier->condition.set_string_value(condition);
 		classifier->action.set_string_value(action);
 		classifier->prediction = prediction;
+		memory.allocate(classifier->footprint());
 		population.push_back(classifier);
 		macro_size++;
 	}
@@ -1958,7 +2263,7 @@ xcs_classifier_system::select_delete_rw(t_classifier_set &set)
 	double		vote_sum;
 	double		vote;
 	double		random;
-	double		size;
+	double		size = 0;
 
 	unsigned long	sel;
 
@@ -2020,6 +2325,9 @@ xcs_classifier_system::delete_classifier()
 	if (population_size<=max_population_size)
 		return;
 
+	//! only the deletions actually performed are timed
+	XCS_PROFILE(profiler, PHASE_DELETION);
+
 	switch(delete_strategy)
 	{
  		case XCS_DELETE_RWS_SETBASED:
@@ -2036,7 +2344,9 @@ xcs_classifier_system::delete_classifier()
 
 	if ((**pp).numerosity>1)
 	{
+		account(**pp, -1);
 		(**pp).numerosity--;
+		account(**pp, 1);
 		population_size--;
 	} else {
 		//	remove cl from [M], [A], and [A]-1
@@ -2059,6 +2369,10 @@ xcs_classifier_system::delete_classifier()
 			previous_action_set.erase(clp);
 		}
 
+		forget_classifier(*pp);
+
+		account(**pp, -1);
+		memory.release((**pp).footprint());
 		delete *pp;
 		
 		population.erase(pp);
@@ -2119,7 +2433,6 @@ xcs_classifier_system::average_gradient(const t_classifier_set &set) const
 void
 xcs_classifier_system::ga_a_subsume(t_classifier_set &action_set, const t_classifier &cl, t_set_iterator &mg)
 {
-	cout << "SI ";
 	t_set_iterator	as;
 	
 	mg = action_set.end();
@@ -2169,3 +2482,95 @@ xcs_classifier_system::predict(t_state inputs)
 
 	return prediction;
 }
+
+//! the kernel is the one of the snapshot, thus [P] and its snapshots give the same predictions
+void
+xcs_classifier_system::predict(const vector<t_state>& inputs, vector<double>& prediction, vector<bool>& matched) const
+{
+	population_snapshot::predict_batch(inputs, actions(), [this](const string& input, const auto& add) {
+		for(t_set_const_iterator pp=population.begin(); pp!=population.end(); pp++)
+		{
+			if ((**pp).condition.match(input))
+				add((**pp).action.value(), (**pp).prediction, (**pp).fitness);
+		}
+	}, prediction, matched);
+}
+
+void
+xcs_classifier_system::population_arrays(vector<string>& conditions, vector<unsigned long>& actions, vector<double>& predictions, vector<double>& fitness) const
+{
+	conditions.clear();
+	actions.clear();
+	predictions.clear();
+	fitness.clear();
+
+	for(t_set_const_iterator pp=population.begin(); pp!=population.end(); pp++)
+	{
+		conditions.push_back((**pp).condition.string_value());
+		actions.push_back((**pp).action.value());
+		predictions.push_back((**pp).prediction);
+		fitness.push_back((**pp).fitness);
+	}
+}
+
+bool
+xcs_classifier_system::freeze(frozen_population& frozen, const bool flag_table) const
+{
+	vector<string>			conditions;
+	vector<unsigned long>	actions;
+	vector<double>			predictions;
+	vector<double>			fitness;
+
+	population_arrays(conditions, actions, predictions, fitness);
+	return frozen.build(conditions, actions, predictions, fitness, this->actions(), flag_table);
+}
+
+void
+xcs_classifier_system::snapshot(population_snapshot& copy) const
+{
+	vector<string>			conditions;
+	vector<unsigned long>	actions;
+	vector<double>			predictions;
+	vector<double>			fitness;
+
+	population_arrays(conditions, actions, predictions, fitness);
+	copy.build(conditions, actions, predictions, fitness, this->actions());
+}
+
+unsigned long
+xcs_classifier_system::compare(const frozen_population& frozen, const vector<t_state>& inputs, const double tolerance) const
+{
+	vector<double>	scanned_prediction, frozen_prediction;
+	vector<bool>	scanned_matched, frozen_matched;
+	unsigned long	no_mismatches = 0;
+
+	predict(inputs, scanned_prediction, scanned_matched);
+	frozen.predict(inputs, frozen_prediction, frozen_matched);
+
+	for(unsigned long i=0; i<scanned_prediction.size(); i++)
+	{
+		if ((scanned_matched[i]!=frozen_matched[i]) || (fabs(scanned_prediction[i]-frozen_prediction[i])>tolerance))
+			no_mismatches++;
+	}
+
+	return no_mismatches;
+}
+
+/*!
+ * the vectors of pointers that implement the sets are accounted by their capacity, since [M], [A],
+ * and [A]-1 reserve room for the whole population
+ */
+xcs_memory_usage
+xcs_classifier_system::memory_usage() const
+{
+	xcs_memory_usage	result = memory;
+	unsigned long		pointers = population.capacity()+match_set.capacity()+action_set.capacity()+previous_action_set.capacity();
+
+	for(unsigned long i=0; i<batch_match_sets.size(); i++)
+	{
+		pointers += batch_match_sets[i].capacity()+batch_previous_action_sets[i].capacity();
+	}
+
+	result.set_container_bytes(pointers*sizeof(t_classifier*)+select.capacity()*sizeof(double));
+	return result;
+}